@@ -0,0 +1,267 @@
+#include "BVH.h"
+
+#include <algorithm>
+#include <execution>
+#include <numeric>
+#include <ranges>
+
+namespace dae
+{
+	namespace
+	{
+		constexpr uint32_t BVH_LEAF_SIZE{ 4 };
+		constexpr int BVH_BIN_COUNT{ 16 };
+		// Ranges up to this size become tasks of the parallel build phase
+		constexpr uint32_t BVH_TASK_SIZE{ 2048 };
+		// Refits may make the tree this much more expensive to traverse before a rebuild pays off
+		constexpr float BVH_REBUILD_COST{ 1.5f };
+
+		float SurfaceArea(const Vector3& min, const Vector3& max)
+		{
+			const Vector3 extent = max - min;
+			return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+		}
+	}
+
+	void BVH::Build(const std::vector<Bounds>& itemBounds)
+	{
+		const uint32_t itemCount = static_cast<uint32_t>(itemBounds.size());
+
+		m_Nodes.clear();
+		m_Items.resize(itemCount);
+		m_ItemMin.resize(itemCount);
+		m_ItemMax.resize(itemCount);
+		m_ItemLeaves.resize(itemCount);
+		std::vector<Vector3> centroids(itemCount);
+
+		std::iota(m_Items.begin(), m_Items.end(), 0);
+		for (uint32_t item = 0; item < itemCount; ++item)
+		{
+			m_ItemMin[item] = itemBounds[item].min;
+			m_ItemMax[item] = itemBounds[item].max;
+			centroids[item] = (itemBounds[item].min + itemBounds[item].max) * 0.5f;
+		}
+
+		m_BuildCost = m_Cost = 0.0f;
+		if (itemCount == 0) return;
+
+		// The top of the tree is split serially until the ranges are small enough to build independently
+		std::vector<Range> tasks{};
+		m_Nodes.push_back({});
+		BuildNode(m_Nodes, 0, UINT32_MAX, 0, itemCount, centroids, &tasks);
+
+		std::vector<std::vector<Node>> subtrees(tasks.size());
+		const auto taskRange = std::views::iota(size_t{ 0 }, tasks.size());
+		std::for_each(std::execution::par, taskRange.begin(), taskRange.end(), [&](size_t task)
+		{
+			subtrees[task].push_back({});
+			BuildNode(subtrees[task], 0, UINT32_MAX, tasks[task].begin, tasks[task].end, centroids, nullptr);
+		});
+
+		// Subtree roots replace their placeholder, the other nodes are appended
+		for (size_t task = 0; task < tasks.size(); ++task)
+		{
+			const std::vector<Node>& subtree = subtrees[task];
+			const uint32_t root = tasks[task].node;
+			const uint32_t offset = static_cast<uint32_t>(m_Nodes.size()) - 1;
+
+			const auto remap = [&](uint32_t node) { return (node == 0) ? root : node + offset; };
+
+			for (uint32_t node = 0; node < subtree.size(); ++node)
+			{
+				Node copy = subtree[node];
+				copy.parent = (node == 0) ? m_Nodes[root].parent : remap(copy.parent);
+				if (copy.count == 0) copy.first = remap(copy.first);
+
+				if (node == 0) m_Nodes[root] = copy;
+				else m_Nodes.push_back(copy);
+			}
+		}
+
+		for (uint32_t node = 0; node < m_Nodes.size(); ++node)
+		{
+			for (uint32_t i = m_Nodes[node].first; i < m_Nodes[node].first + m_Nodes[node].count; ++i)
+			{
+				m_ItemLeaves[m_Items[i]] = node;
+			}
+		}
+
+		m_Cost = CalculateCost();
+		const float rootArea = SurfaceArea(m_Nodes[0].min, m_Nodes[0].max);
+		m_BuildCost = (rootArea > 0.0f) ? m_Cost / rootArea : 0.0f;
+	}
+
+	void BVH::BuildNode(std::vector<Node>& nodes, uint32_t nodeIndex, uint32_t parent, uint32_t begin, uint32_t end, const std::vector<Vector3>& centroids, std::vector<Range>* pTasks)
+	{
+		Vector3 min{ FLT_MAX, FLT_MAX, FLT_MAX };
+		Vector3 max{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+		Vector3 centroidMin{ FLT_MAX, FLT_MAX, FLT_MAX };
+		Vector3 centroidMax{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			const uint32_t item = m_Items[i];
+			min = Vector3::Min(min, m_ItemMin[item]);
+			max = Vector3::Max(max, m_ItemMax[item]);
+			centroidMin = Vector3::Min(centroidMin, centroids[item]);
+			centroidMax = Vector3::Max(centroidMax, centroids[item]);
+		}
+
+		const uint32_t count = end - begin;
+		nodes[nodeIndex] = { min, max, parent, begin, count };
+
+		if (count <= BVH_LEAF_SIZE) return;
+
+		if (pTasks && count <= BVH_TASK_SIZE)
+		{
+			pTasks->push_back({ nodeIndex, begin, end });
+			return;
+		}
+
+		// Split along the largest centroid extent
+		const Vector3 extent = centroidMax - centroidMin;
+		const int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z ? 1 : 2);
+
+		// Halves unless binning finds a split, items on top of each other all fall in one bin
+		uint32_t middle = begin + count / 2;
+
+		if (extent[axis] > 0.0f)
+		{
+			const float binScale = BVH_BIN_COUNT / extent[axis];
+			const auto getBin = [&](uint32_t item)
+			{
+				return std::min(static_cast<int>((centroids[item][axis] - centroidMin[axis]) * binScale), BVH_BIN_COUNT - 1);
+			};
+
+			struct Bin
+			{
+				Vector3 min{ FLT_MAX, FLT_MAX, FLT_MAX };
+				Vector3 max{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+				uint32_t count{};
+			};
+
+			Bin bins[BVH_BIN_COUNT]{};
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				const uint32_t item = m_Items[i];
+				Bin& bin = bins[getBin(item)];
+				bin.min = Vector3::Min(bin.min, m_ItemMin[item]);
+				bin.max = Vector3::Max(bin.max, m_ItemMax[item]);
+				++bin.count;
+			}
+
+			// Surface area heuristic for every split between two bins, the right side swept from the end
+			float rightCost[BVH_BIN_COUNT]{};
+			Bin right{};
+			for (int b = BVH_BIN_COUNT - 1; b > 0; --b)
+			{
+				right.min = Vector3::Min(right.min, bins[b].min);
+				right.max = Vector3::Max(right.max, bins[b].max);
+				right.count += bins[b].count;
+				rightCost[b] = (right.count > 0) ? SurfaceArea(right.min, right.max) * right.count : 0.0f;
+			}
+
+			int bestSplit{ -1 };
+			float bestCost{ FLT_MAX };
+			Bin left{};
+			for (int b = 1; b < BVH_BIN_COUNT; ++b)
+			{
+				left.min = Vector3::Min(left.min, bins[b - 1].min);
+				left.max = Vector3::Max(left.max, bins[b - 1].max);
+				left.count += bins[b - 1].count;
+
+				if (left.count == 0 || left.count == count) continue;
+
+				const float cost = SurfaceArea(left.min, left.max) * left.count + rightCost[b];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestSplit = b;
+				}
+			}
+
+			if (bestSplit > 0)
+			{
+				middle = static_cast<uint32_t>(std::partition(m_Items.begin() + begin, m_Items.begin() + end, [&](uint32_t item) { return getBin(item) < bestSplit; }) - m_Items.begin());
+			}
+		}
+
+		const uint32_t children = static_cast<uint32_t>(nodes.size());
+		nodes.resize(nodes.size() + 2);
+		nodes[nodeIndex].first = children;
+		nodes[nodeIndex].count = 0;
+
+		BuildNode(nodes, children, nodeIndex, begin, middle, centroids, pTasks);
+		BuildNode(nodes, children + 1, nodeIndex, middle, end, centroids, pTasks);
+	}
+
+	void BVH::Refit(uint32_t item, const Bounds& bounds)
+	{
+		m_ItemMin[item] = bounds.min;
+		m_ItemMax[item] = bounds.max;
+
+		uint32_t nodeIndex = m_ItemLeaves[item];
+
+		while (nodeIndex != UINT32_MAX)
+		{
+			Node& node = m_Nodes[nodeIndex];
+
+			Vector3 min{ FLT_MAX, FLT_MAX, FLT_MAX };
+			Vector3 max{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+			if (node.count > 0)
+			{
+				for (uint32_t i = node.first; i < node.first + node.count; ++i)
+				{
+					min = Vector3::Min(min, m_ItemMin[m_Items[i]]);
+					max = Vector3::Max(max, m_ItemMax[m_Items[i]]);
+				}
+			}
+			else
+			{
+				min = Vector3::Min(m_Nodes[node.first].min, m_Nodes[node.first + 1].min);
+				max = Vector3::Max(m_Nodes[node.first].max, m_Nodes[node.first + 1].max);
+			}
+
+			if (min == node.min && max == node.max) break;
+
+			// Keeps the unnormalized cost of CalculateCost current
+			const float weight = static_cast<float>(std::max(node.count, 1u));
+			m_Cost += (SurfaceArea(min, max) - SurfaceArea(node.min, node.max)) * weight;
+
+			node.min = min;
+			node.max = max;
+			nodeIndex = node.parent;
+		}
+	}
+
+	bool BVH::NeedsRebuild() const
+	{
+		if (m_Nodes.empty()) return false;
+
+		// Costs relative to the root, so a tree that only grew as a whole does not count as degraded
+		const float rootArea = SurfaceArea(m_Nodes[0].min, m_Nodes[0].max);
+		return rootArea > 0.0f && m_Cost / rootArea > BVH_REBUILD_COST * m_BuildCost;
+	}
+
+	size_t BVH::GetItemCount() const
+	{
+		return m_Items.size();
+	}
+
+	size_t BVH::GetNodeCount() const
+	{
+		return m_Nodes.size();
+	}
+
+	float BVH::CalculateCost() const
+	{
+		// Surface area of every node, leaves weighted by their items
+		float cost{};
+		for (const Node& node : m_Nodes)
+		{
+			cost += SurfaceArea(node.min, node.max) * std::max(node.count, 1u);
+		}
+		return cost;
+	}
+}
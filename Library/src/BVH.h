@@ -0,0 +1,119 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Bounds.h"
+#include "Frustum.h"
+
+namespace dae
+{
+	// Bounding volume hierarchy over the boxes of a set of items, named by their index in the vector given to Build
+	// Moving items are refit in place, Build starts over once refitting has made the tree too loose
+	class BVH final
+	{
+	public:
+		BVH() = default;
+		~BVH() = default;
+
+		BVH(const BVH&) = delete;
+		BVH(BVH&&) noexcept = delete;
+		BVH& operator=(const BVH&) = delete;
+		BVH& operator=(BVH&&) noexcept = delete;
+
+		// Binned SAH build, the subtrees below the first levels are built in parallel
+		void Build(const std::vector<Bounds>& itemBounds);
+
+		// Replaces the box of an item and grows or shrinks its ancestors, stopping at the first one that does not change
+		void Refit(uint32_t item, const Bounds& bounds);
+
+		// True when refits made the expected traversal cost grow past BVH_REBUILD_COST times the cost right after Build
+		bool NeedsRebuild() const;
+
+		// Calls visitor(item) for every item whose box is not outside the frustum, subtrees fully inside are visited without further tests
+		template<typename Visitor>
+		void QueryFrustum(const Frustum& frustum, Visitor&& visitor) const;
+
+		size_t GetItemCount() const;
+		size_t GetNodeCount() const;
+
+	private:
+		struct Node
+		{
+			Vector3 min;
+			Vector3 max;
+			uint32_t parent;
+			// Inner nodes: first of two adjacent children. Leaves: first entry in m_Items
+			uint32_t first;
+			// Items of a leaf, 0 for inner nodes
+			uint32_t count;
+		};
+
+		std::vector<Node> m_Nodes{};
+		// Items ordered so every leaf covers a range
+		std::vector<uint32_t> m_Items{};
+		std::vector<Vector3> m_ItemMin{};
+		std::vector<Vector3> m_ItemMax{};
+		std::vector<uint32_t> m_ItemLeaves{};
+
+		// Sum of the node surface areas, leaves weighted by their item count. The build cost is relative to the root area
+		float m_Cost{};
+		float m_BuildCost{};
+
+		struct Range
+		{
+			uint32_t node;
+			uint32_t begin;
+			uint32_t end;
+		};
+
+		// Fills nodes[nodeIndex] for m_Items[begin, end) and splits it recursively, ranges small enough for a task of their own are left to pTasks
+		void BuildNode(std::vector<Node>& nodes, uint32_t nodeIndex, uint32_t parent, uint32_t begin, uint32_t end, const std::vector<Vector3>& centroids, std::vector<Range>* pTasks);
+		float CalculateCost() const;
+	};
+
+	template<typename Visitor>
+	void BVH::QueryFrustum(const Frustum& frustum, Visitor&& visitor) const
+	{
+		if (m_Nodes.empty()) return;
+
+		// Nodes to visit, each with whether it still needs a frustum test
+		struct Entry
+		{
+			uint32_t node;
+			bool isInside;
+		};
+
+		std::vector<Entry> stack{};
+		stack.reserve(64);
+		stack.push_back({ 0, false });
+
+		while (!stack.empty())
+		{
+			const Entry entry = stack.back();
+			stack.pop_back();
+			const Node& node = m_Nodes[entry.node];
+
+			bool isInside = entry.isInside;
+			if (!isInside)
+			{
+				if (frustum.IsBoxOutside(node.min, node.max)) continue;
+				isInside = frustum.IsBoxInside(node.min, node.max);
+			}
+
+			if (node.count > 0)
+			{
+				for (uint32_t i = node.first; i < node.first + node.count; ++i)
+				{
+					const uint32_t item = m_Items[i];
+					if (isInside || node.count == 1 || !frustum.IsBoxOutside(m_ItemMin[item], m_ItemMax[item])) visitor(item);
+				}
+			}
+			else
+			{
+				stack.push_back({ node.first + 1, isInside });
+				stack.push_back({ node.first, isInside });
+			}
+		}
+	}
+}
@@ -0,0 +1,63 @@
+#include "Bounds.h"
+
+#include <algorithm>
+
+#include "DataTypes.h"
+
+namespace dae
+{
+	Bounds Bounds::FromVertices(const std::vector<Vertex>& vertices)
+	{
+		Bounds bounds{};
+
+		for (const Vertex& vertex : vertices)
+		{
+			bounds.min = Vector3::Min(bounds.min, vertex.position);
+			bounds.max = Vector3::Max(bounds.max, vertex.position);
+		}
+
+		if (bounds.IsEmpty()) return bounds;
+
+		bounds.center = (bounds.min + bounds.max) * 0.5f;
+
+		for (const Vertex& vertex : vertices)
+		{
+			bounds.radius = std::max(bounds.radius, (vertex.position - bounds.center).Magnitude());
+		}
+
+		return bounds;
+	}
+
+	bool Bounds::IsEmpty() const
+	{
+		return min.x > max.x;
+	}
+
+	Bounds Bounds::Transformed(const Matrix& matrix) const
+	{
+		if (IsEmpty()) return *this;
+
+		Bounds bounds{};
+		bounds.min = bounds.max = matrix.GetTranslation();
+
+		// Every output axis sums the smallest and largest contribution of each input axis
+		for (int row = 0; row < 3; ++row)
+		{
+			const Vector3 axis = matrix[row];
+
+			for (int column = 0; column < 3; ++column)
+			{
+				const float a = axis[column] * min[row];
+				const float b = axis[column] * max[row];
+
+				bounds.min[column] += std::min(a, b);
+				bounds.max[column] += std::max(a, b);
+			}
+		}
+
+		bounds.center = matrix.TransformPoint(center);
+		bounds.radius = radius * matrix.GetMaxScale();
+
+		return bounds;
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cfloat>
+#include <vector>
+
+#include "Matrix.h"
+#include "Vector3.h"
+
+namespace dae
+{
+	struct Vertex;
+
+	// Axis aligned box with the sphere around it, empty until built from points
+	struct Bounds
+	{
+		Vector3 min{ FLT_MAX, FLT_MAX, FLT_MAX };
+		Vector3 max{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+		// Sphere around the center of the box, through the furthest point
+		Vector3 center{};
+		float radius{};
+
+		static Bounds FromVertices(const std::vector<Vertex>& vertices);
+
+		bool IsEmpty() const;
+
+		// Box around the transformed box (Arvo), sphere scaled by the largest axis of the matrix
+		Bounds Transformed(const Matrix& matrix) const;
+	};
+}
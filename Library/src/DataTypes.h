@@ -1,8 +1,11 @@
 #pragma once
+#include "Bounds.h"
 #include "Maths.h"
 #include "vector"
 #include "Texture.h"
 
+#include <cstdint>
+#include <limits>
 #include <memory>
 
 namespace dae
@@ -16,6 +19,23 @@ namespace dae
 		Vector3 tangent{}; //W4
 	};
 
+	// Compact encoding of Vertex (22 instead of 56 bytes), decoded in the vertex stage
+	struct QuantizedVertex
+	{
+		uint16_t position[3]{};	// unorm16 within the mesh quantization box
+		uint16_t uv[2]{};		// half floats
+		int16_t normal[2]{};	// octahedral snorm16
+		int16_t tangent[2]{};	// octahedral snorm16
+		uint8_t color[4]{};		// unorm8 rgb, a unused
+	};
+
+	// position = offset + quantized * scale
+	struct QuantizationBox
+	{
+		Vector3 offset{};
+		Vector3 scale{};
+	};
+
 	struct Vertex_Out
 	{
 		Vector4 position{};
@@ -32,13 +52,66 @@ namespace dae
 		TriangleStrip
 	};
 
+	// Index that ends the current triangle strip, the next index starts a new one (0xFFFFFFFF, or 0xFFFF for 16-bit indices)
+	template<typename Index>
+	constexpr Index PRIMITIVE_RESTART_INDEX{ std::numeric_limits<Index>::max() };
+
+	// Level of detail of a mesh, a range of its index buffer drawn in place of the full mesh
+	struct MeshLOD
+	{
+		uint32_t indexOffset{};
+		uint32_t indexCount{};
+		// Vertices [0, vertexCount) cover every index of the range
+		uint32_t vertexCount{};
+		// Estimated distance between the simplified and the full surface, in mesh units
+		float error{};
+		// Range of Mesh::meshlets covering the same triangles, when the mesh has meshlets
+		uint32_t meshletOffset{};
+		uint32_t meshletCount{};
+	};
+
+	// Cluster of neighbouring triangles, culled as a whole before any of its vertices are transformed
+	struct Meshlet
+	{
+		// Range of Mesh::indices (or indices16) drawn for the cluster
+		uint32_t indexOffset{};
+		uint32_t indexCount{};
+		// Range of Mesh::meshletVertices listing every vertex the cluster uses
+		uint32_t vertexOffset{};
+		uint32_t vertexCount{};
+
+		// Bounding sphere, in mesh units
+		Vector3 center{};
+		float radius{};
+
+		// Cone around the triangle normals (winding order cross(p1 - p0, p2 - p0)), the whole cluster faces away from a viewer when
+		// dot(center - viewer, coneAxis) >= coneCutoff * |center - viewer| + radius. A cutoff of 1 never culls
+		Vector3 coneAxis{};
+		float coneCutoff{ 1.0f };
+	};
+
+	// Geometry resource, shared by every object drawing it and never written by the renderer
 	struct Mesh
 	{
 		std::vector<Vertex> vertices{};
 		std::vector<uint32_t> indices{};
 		PrimitiveTopology primitiveTopology{ PrimitiveTopology::TriangleStrip };
+		// Strips are split at PRIMITIVE_RESTART_INDEX instead of drawing through it
+		bool primitiveRestart{ false };
+
+		// Optional compact streams, used instead of vertices/indices when not empty
+		std::vector<QuantizedVertex> quantizedVertices{};
+		std::vector<uint16_t> indices16{};
+		QuantizationBox quantizationBox{};
+
+		// Optional LOD chain, lods[0] is the full detail mesh and every next level is coarser
+		std::vector<MeshLOD> lods{};
+
+		// Optional clusters covering the index buffer, with the vertex lists they reference
+		std::vector<Meshlet> meshlets{};
+		std::vector<uint32_t> meshletVertices{};
 
-		std::vector<Vertex_Out> vertices_out{};
-		Matrix worldMatrix{};
+		// Local space bounds of the positions, filled at load
+		Bounds bounds{};
 	};
 }
@@ -0,0 +1,77 @@
+#pragma once
+#include <cfloat>
+#include <cstdint>
+
+namespace dae
+{
+	enum class DepthFormat
+	{
+		// z / w as projected, 0 at the near plane
+		Float32,
+		// z / w of Matrix::CreatePerspectiveFovLHReversedZ, 1 at the near plane, where float precision is spent on the far distance
+		ReversedFloat32,
+		// Half the bandwidth of Float32, for depth-only passes
+		Unorm16,
+		// Depth in the upper 24 bits, the stencil value of the object in the lower 8
+		Unorm24Stencil8
+	};
+
+	// Encoding of each format: Encode converts z / w in [0, 1] to the stored value, Decode back, and Passes is the depth test
+	// A value passes against an equal stored value, so coplanar triangles drawn later still overwrite
+	namespace DepthEncoding
+	{
+		struct Float32
+		{
+			using Value = float;
+			static constexpr Value CLEAR{ FLT_MAX };
+
+			static Value Encode(float depth, uint8_t = 0) { return depth; }
+			static float Decode(Value value) { return value; }
+			static bool Passes(Value value, Value stored) { return value <= stored; }
+		};
+
+		struct ReversedFloat32
+		{
+			using Value = float;
+			static constexpr Value CLEAR{ 0.0f };
+
+			static Value Encode(float depth, uint8_t = 0) { return depth; }
+			static float Decode(Value value) { return value; }
+			static bool Passes(Value value, Value stored) { return value >= stored; }
+		};
+
+		struct Unorm16
+		{
+			using Value = uint16_t;
+			static constexpr Value CLEAR{ UINT16_MAX };
+
+			static Value Encode(float depth, uint8_t = 0) { return static_cast<Value>(depth * UINT16_MAX + 0.5f); }
+			static float Decode(Value value) { return value / static_cast<float>(UINT16_MAX); }
+			static bool Passes(Value value, Value stored) { return value <= stored; }
+		};
+
+		struct Unorm24Stencil8
+		{
+			using Value = uint32_t;
+			static constexpr Value CLEAR{ UINT32_MAX & ~Value{ 0xFF } };
+			static constexpr Value DEPTH_MAX{ (1 << 24) - 1 };
+
+			static Value Encode(float depth, uint8_t stencil = 0) { return static_cast<Value>(depth * DEPTH_MAX + 0.5f) << 8 | stencil; }
+			static float Decode(Value value) { return (value >> 8) / static_cast<float>(DEPTH_MAX); }
+			static bool Passes(Value value, Value stored) { return (value >> 8) <= (stored >> 8); }
+			static uint8_t GetStencil(Value value) { return static_cast<uint8_t>(value & 0xFF); }
+		};
+	}
+
+	// Bytes per pixel of the format
+	inline int GetDepthSize(DepthFormat format)
+	{
+		return (format == DepthFormat::Unorm16) ? 2 : 4;
+	}
+
+	// z / w at the screen-space weights of a triangle, it is affine in screen space so it is interpolated linearly in every format
+	inline float InterpolateDepth(float w0, float w1, float w2, float z0, float z1, float z2)
+	{
+		return w0 * z0 + w1 * z1 + w2 * z2;
+	}
+}
@@ -0,0 +1,64 @@
+#include "Frustum.h"
+
+namespace dae
+{
+	Frustum Frustum::FromMatrix(const Matrix& viewProjection)
+	{
+		// Clip coordinates are dot products of the point with the matrix columns (Gribb & Hartmann)
+		const Matrix& m = viewProjection;
+		const Vector4 column0{ m[0].x, m[1].x, m[2].x, m[3].x };
+		const Vector4 column1{ m[0].y, m[1].y, m[2].y, m[3].y };
+		const Vector4 column2{ m[0].z, m[1].z, m[2].z, m[3].z };
+		const Vector4 column3{ m[0].w, m[1].w, m[2].w, m[3].w };
+
+		Frustum frustum{};
+		frustum.planes[0] = column3 + column0;	// Left
+		frustum.planes[1] = column3 - column0;	// Right
+		frustum.planes[2] = column3 + column1;	// Bottom
+		frustum.planes[3] = column3 - column1;	// Top
+		frustum.planes[4] = column2;			// Near
+		frustum.planes[5] = column3 - column2;	// Far
+
+		// Unit normals make the plane equation a signed distance
+		for (Vector4& plane : frustum.planes)
+		{
+			plane = plane * (1.0f / plane.GetXYZ().Magnitude());
+		}
+
+		return frustum;
+	}
+
+	bool Frustum::IsSphereOutside(const Vector3& center, float radius) const
+	{
+		for (const Vector4& plane : planes)
+		{
+			if (Vector3::Dot(plane.GetXYZ(), center) + plane.w < -radius) return true;
+		}
+
+		return false;
+	}
+
+	bool Frustum::IsBoxOutside(const Vector3& min, const Vector3& max) const
+	{
+		for (const Vector4& plane : planes)
+		{
+			// Corner furthest along the plane normal
+			const Vector3 corner{ plane.x >= 0.0f ? max.x : min.x, plane.y >= 0.0f ? max.y : min.y, plane.z >= 0.0f ? max.z : min.z };
+			if (Vector3::Dot(plane.GetXYZ(), corner) + plane.w < 0.0f) return true;
+		}
+
+		return false;
+	}
+
+	bool Frustum::IsBoxInside(const Vector3& min, const Vector3& max) const
+	{
+		for (const Vector4& plane : planes)
+		{
+			// Corner furthest against the plane normal
+			const Vector3 corner{ plane.x >= 0.0f ? min.x : max.x, plane.y >= 0.0f ? min.y : max.y, plane.z >= 0.0f ? min.z : max.z };
+			if (Vector3::Dot(plane.GetXYZ(), corner) + plane.w < 0.0f) return false;
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include "Matrix.h"
+#include "Vector3.h"
+#include "Vector4.h"
+
+namespace dae
+{
+	// Clip volume of a camera as six planes (xyz normal pointing inwards, w distance), in the space the matrix transforms from
+	struct Frustum
+	{
+		Vector4 planes[6]{};
+
+		// Planes of a row-vector (world) view projection matrix with a [0, 1] depth range
+		static Frustum FromMatrix(const Matrix& viewProjection);
+
+		// True when the sphere lies completely behind one of the planes
+		bool IsSphereOutside(const Vector3& center, float radius) const;
+		// True when the axis aligned box lies completely behind one of the planes
+		bool IsBoxOutside(const Vector3& min, const Vector3& max) const;
+		// True when the axis aligned box lies completely in front of every plane
+		bool IsBoxInside(const Vector3& min, const Vector3& max) const;
+	};
+}
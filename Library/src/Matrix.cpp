@@ -1,5 +1,6 @@
 #include "Matrix.h"
 
+#include <algorithm>
 #include <cassert>
 
 #include "MathHelpers.h"
@@ -161,6 +162,16 @@ namespace dae {
 		};
 	}
 
+	Matrix Matrix::CreatePerspectiveFovLHReversedZ(float fov, float aspect, float zn, float zf)
+	{
+		return {
+			{ 1.0f / (aspect * fov), 0.0f, 0.0f, 0.0f },
+			{ 0.0f, 1.0f / fov, 0.0f, 0.0f },
+			{ 0.0f, 0.0f, zn / (zn - zf), 1.0f },
+			{ 0.0f, 0.0f, -(zf * zn) / (zn - zf), 0.0f }
+		};
+	}
+
 	Vector3 Matrix::GetAxisX() const
 	{
 		return data[0];
@@ -181,6 +192,11 @@ namespace dae {
 		return data[3];
 	}
 
+	float Matrix::GetMaxScale() const
+	{
+		return std::max({ GetAxisX().Magnitude(), GetAxisY().Magnitude(), GetAxisZ().Magnitude() });
+	}
+
 	Matrix Matrix::CreateTranslation(float x, float y, float z)
 	{
 		return CreateTranslation({ x, y, z });
@@ -35,6 +35,8 @@ namespace dae {
 		Vector3 GetAxisY() const;
 		Vector3 GetAxisZ() const;
 		Vector3 GetTranslation() const;
+		// Largest length of the x, y and z axes, the most a distance can grow under the matrix
+		float GetMaxScale() const;
 
 		static Matrix CreateTranslation(float x, float y, float z);
 		static Matrix CreateTranslation(const Vector3& t);
@@ -50,6 +52,8 @@ namespace dae {
 
 		static Matrix CreateLookAtLH(const Vector3& origin, const Vector3& forward, const Vector3& up);
 		static Matrix CreatePerspectiveFovLH(float fovy, float aspect, float zn, float zf);
+		// Maps the near plane to depth 1 and the far plane to 0, computed directly rather than flipping the standard one so no precision is lost
+		static Matrix CreatePerspectiveFovLHReversedZ(float fovy, float aspect, float zn, float zf);
 
 		Vector4& operator[](int index);
 		Vector4 operator[](int index) const;
@@ -0,0 +1,395 @@
+#include "MeshCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "MappedFile.h"
+#include "MeshCodec.h"
+#include "MeshOptimizer.h"
+#include "Quantization.h"
+#include "Utils.h"
+
+namespace dae
+{
+	namespace MeshCache
+	{
+		namespace
+		{
+			constexpr char MAGIC[4]{ 'D', 'M', 'S', 'H' };
+			constexpr uint32_t VERSION{ 6 };
+
+			enum class Encoding : uint32_t
+			{
+				// Vertex and uint32_t index streams in their in-memory layout
+				Raw,
+				// QuantizedVertex and index streams compressed with MeshCodec
+				Compressed
+			};
+
+			// Every level of detail aims at half the triangles of the previous one and may add at most MAX_LOD_ERROR times the mesh size to the error,
+			// the chain ends when a level removes less than a fifth of the triangles
+			constexpr size_t MAX_LOD_COUNT{ 6 };
+			constexpr size_t MIN_LOD_TRIANGLES{ 64 };
+			constexpr float MAX_LOD_ERROR{ 0.01f };
+
+			// File layout: header, vertex stream, index stream, LOD table, meshlet table, meshlet vertex lists. Streams start at the offsets stored in the header
+			struct Header
+			{
+				char magic[4];
+				uint32_t version;
+				uint32_t vertexSize;
+				uint32_t primitiveTopology;
+				uint32_t primitiveRestart;
+
+				uint64_t sourceSize;
+				int64_t sourceTime;
+
+				Encoding encoding;
+				QuantizationBox quantizationBox;
+
+				uint64_t vertexCount;
+				uint64_t vertexOffset;
+				uint64_t vertexBytes;
+				uint64_t indexCount;
+				uint64_t indexOffset;
+				uint64_t indexBytes;
+				uint64_t lodCount;
+				uint64_t lodOffset;
+				uint64_t meshletCount;
+				uint64_t meshletOffset;
+				uint64_t meshletVertexCount;
+				uint64_t meshletVertexOffset;
+
+				// Local space bounds of the positions
+				Bounds bounds;
+			};
+
+			bool GetSourceStamp(const std::string& sourcePath, uint64_t& size, int64_t& time)
+			{
+				std::error_code error;
+
+				size = std::filesystem::file_size(sourcePath, error);
+				if (error) return false;
+
+				time = std::filesystem::last_write_time(sourcePath, error).time_since_epoch().count();
+				return !error;
+			}
+
+			// Lists the distinct vertices of every meshlet, in order of first use
+			void FillMeshletVertices(Mesh& mesh)
+			{
+				std::vector<uint32_t> owner(mesh.vertices.size(), UINT32_MAX);
+				mesh.meshletVertices.clear();
+
+				for (uint32_t meshletIndex = 0; meshletIndex < mesh.meshlets.size(); ++meshletIndex)
+				{
+					Meshlet& meshlet = mesh.meshlets[meshletIndex];
+					meshlet.vertexOffset = static_cast<uint32_t>(mesh.meshletVertices.size());
+
+					for (uint32_t i = meshlet.indexOffset; i < meshlet.indexOffset + meshlet.indexCount; ++i)
+					{
+						const uint32_t index = mesh.indices[i];
+						if (index == PRIMITIVE_RESTART_INDEX<uint32_t> || owner[index] == meshletIndex) continue;
+
+						owner[index] = meshletIndex;
+						mesh.meshletVertices.push_back(index);
+					}
+
+					meshlet.vertexCount = static_cast<uint32_t>(mesh.meshletVertices.size()) - meshlet.vertexOffset;
+				}
+			}
+		}
+
+		std::string GetCachePath(const std::string& sourcePath)
+		{
+			return std::filesystem::path{ sourcePath }.replace_extension(".mesh").string();
+		}
+
+		bool Write(const std::string& cachePath, const std::string& sourcePath, const Mesh& mesh)
+		{
+			Header header{};
+			std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+			header.version = VERSION;
+			header.primitiveTopology = static_cast<uint32_t>(mesh.primitiveTopology);
+			header.primitiveRestart = mesh.primitiveRestart;
+
+			if (!GetSourceStamp(sourcePath, header.sourceSize, header.sourceTime)) return false;
+
+			const char* pVertexData{};
+			const char* pIndexData{};
+			std::vector<uint8_t> compressedVertices{};
+			std::vector<uint8_t> compressedIndices{};
+
+			if (mesh.quantizedVertices.empty())
+			{
+				header.encoding = Encoding::Raw;
+				header.vertexSize = sizeof(Vertex);
+				header.vertexCount = mesh.vertices.size();
+				header.vertexBytes = mesh.vertices.size() * sizeof(Vertex);
+				header.indexCount = mesh.indices.size();
+				header.indexBytes = mesh.indices.size() * sizeof(uint32_t);
+
+				pVertexData = reinterpret_cast<const char*>(mesh.vertices.data());
+				pIndexData = reinterpret_cast<const char*>(mesh.indices.data());
+			}
+			else
+			{
+				// Quantized meshes are stored compressed, the codec is lossless so they load back bit-identical
+				compressedVertices = MeshCodec::EncodeVertices(mesh.quantizedVertices);
+				compressedIndices = MeshCodec::EncodeIndices(mesh.indices16.empty() ? mesh.indices : std::vector<uint32_t>(mesh.indices16.begin(), mesh.indices16.end()));
+
+				header.encoding = Encoding::Compressed;
+				header.quantizationBox = mesh.quantizationBox;
+				header.vertexSize = sizeof(QuantizedVertex);
+				header.vertexCount = mesh.quantizedVertices.size();
+				header.vertexBytes = compressedVertices.size();
+				header.indexCount = mesh.indices16.empty() ? mesh.indices.size() : mesh.indices16.size();
+				header.indexBytes = compressedIndices.size();
+
+				pVertexData = reinterpret_cast<const char*>(compressedVertices.data());
+				pIndexData = reinterpret_cast<const char*>(compressedIndices.data());
+			}
+
+			header.bounds = mesh.bounds;
+
+			header.vertexOffset = sizeof(Header);
+			header.indexOffset = header.vertexOffset + header.vertexBytes;
+			header.lodCount = mesh.lods.size();
+			header.lodOffset = header.indexOffset + header.indexBytes;
+			header.meshletCount = mesh.meshlets.size();
+			header.meshletOffset = header.lodOffset + header.lodCount * sizeof(MeshLOD);
+			header.meshletVertexCount = mesh.meshletVertices.size();
+			header.meshletVertexOffset = header.meshletOffset + header.meshletCount * sizeof(Meshlet);
+
+			std::ofstream file(cachePath, std::ios::binary | std::ios::trunc);
+			if (!file) return false;
+
+			file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+			file.write(pVertexData, header.vertexBytes);
+			file.write(pIndexData, header.indexBytes);
+			file.write(reinterpret_cast<const char*>(mesh.lods.data()), header.lodCount * sizeof(MeshLOD));
+			file.write(reinterpret_cast<const char*>(mesh.meshlets.data()), header.meshletCount * sizeof(Meshlet));
+			file.write(reinterpret_cast<const char*>(mesh.meshletVertices.data()), header.meshletVertexCount * sizeof(uint32_t));
+
+			return static_cast<bool>(file);
+		}
+
+		bool Read(const std::string& cachePath, const std::string& sourcePath, Mesh& mesh)
+		{
+			MappedFile file{ cachePath };
+			if (!file.IsOpen() || file.GetSize() < sizeof(Header)) return false;
+
+			Header header;
+			std::memcpy(&header, file.GetData(), sizeof(Header));
+
+			if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) return false;
+
+			// A missing source is fine (shipped without OBJ), a changed one makes the cache stale
+			uint64_t sourceSize;
+			int64_t sourceTime;
+			if (GetSourceStamp(sourcePath, sourceSize, sourceTime) && (sourceSize != header.sourceSize || sourceTime != header.sourceTime)) return false;
+
+			if (header.vertexOffset + header.vertexBytes > file.GetSize()) return false;
+			if (header.indexOffset + header.indexBytes > file.GetSize()) return false;
+			if (header.lodOffset + header.lodCount * sizeof(MeshLOD) > file.GetSize()) return false;
+			if (header.meshletOffset + header.meshletCount * sizeof(Meshlet) > file.GetSize()) return false;
+			if (header.meshletVertexOffset + header.meshletVertexCount * sizeof(uint32_t) > file.GetSize()) return false;
+
+			const auto pVertexData = reinterpret_cast<const uint8_t*>(file.GetData() + header.vertexOffset);
+			const auto pIndexData = reinterpret_cast<const uint8_t*>(file.GetData() + header.indexOffset);
+
+			switch (header.encoding)
+			{
+				case Encoding::Raw:
+				{
+					if (header.vertexSize != sizeof(Vertex)) return false;
+					if (header.vertexBytes != header.vertexCount * sizeof(Vertex) || header.indexBytes != header.indexCount * sizeof(uint32_t)) return false;
+
+					// The streams are stored in their in-memory layout, so each one is a single bulk copy out of the mapping
+					const auto pVertices = reinterpret_cast<const Vertex*>(pVertexData);
+					const auto pIndices = reinterpret_cast<const uint32_t*>(pIndexData);
+
+					mesh.vertices.assign(pVertices, pVertices + header.vertexCount);
+					mesh.indices.assign(pIndices, pIndices + header.indexCount);
+					mesh.quantizedVertices.clear();
+					mesh.indices16.clear();
+					break;
+				}
+
+				case Encoding::Compressed:
+				{
+					if (header.vertexSize != sizeof(QuantizedVertex)) return false;
+
+					std::vector<uint32_t> indices{};
+					if (!MeshCodec::DecodeVertices(pVertexData, header.vertexBytes, mesh.quantizedVertices)) return false;
+					if (!MeshCodec::DecodeIndices(pIndexData, header.indexBytes, indices)) return false;
+					if (mesh.quantizedVertices.size() != header.vertexCount || indices.size() != header.indexCount) return false;
+
+					// Same index width rule as Quantization::QuantizeMesh, 16-bit streams are stored widened so restart indices narrow back unchanged
+					if (Quantization::FitsIndices16(mesh.quantizedVertices.size(), header.primitiveRestart))
+					{
+						mesh.indices16.assign(indices.begin(), indices.end());
+						mesh.indices.clear();
+					}
+					else
+					{
+						mesh.indices = std::move(indices);
+						mesh.indices16.clear();
+					}
+
+					mesh.vertices.clear();
+					mesh.quantizationBox = header.quantizationBox;
+					break;
+				}
+
+				default:
+					return false;
+			}
+
+			mesh.primitiveTopology = static_cast<PrimitiveTopology>(header.primitiveTopology);
+			mesh.primitiveRestart = header.primitiveRestart;
+			mesh.bounds = header.bounds;
+
+			const auto pLODs = reinterpret_cast<const MeshLOD*>(file.GetData() + header.lodOffset);
+			mesh.lods.assign(pLODs, pLODs + header.lodCount);
+
+			for (const MeshLOD& lod : mesh.lods)
+			{
+				if (static_cast<uint64_t>(lod.indexOffset) + lod.indexCount > header.indexCount || lod.vertexCount > header.vertexCount) return false;
+				if (static_cast<uint64_t>(lod.meshletOffset) + lod.meshletCount > header.meshletCount) return false;
+			}
+
+			const auto pMeshlets = reinterpret_cast<const Meshlet*>(file.GetData() + header.meshletOffset);
+			const auto pMeshletVertices = reinterpret_cast<const uint32_t*>(file.GetData() + header.meshletVertexOffset);
+			mesh.meshlets.assign(pMeshlets, pMeshlets + header.meshletCount);
+			mesh.meshletVertices.assign(pMeshletVertices, pMeshletVertices + header.meshletVertexCount);
+
+			for (const Meshlet& meshlet : mesh.meshlets)
+			{
+				if (static_cast<uint64_t>(meshlet.indexOffset) + meshlet.indexCount > header.indexCount) return false;
+				if (static_cast<uint64_t>(meshlet.vertexOffset) + meshlet.vertexCount > header.meshletVertexCount) return false;
+			}
+
+			for (uint32_t index : mesh.meshletVertices)
+			{
+				if (index >= header.vertexCount) return false;
+			}
+
+			return true;
+		}
+
+		bool LoadOBJ(const std::string& objPath, Mesh& mesh, const LoadOptions& options)
+		{
+			const std::string cachePath = GetCachePath(objPath);
+			const PrimitiveTopology topology = options.stripify ? PrimitiveTopology::TriangleStrip : PrimitiveTopology::TriangleList;
+
+			const bool primitiveRestart = options.stripify && options.primitiveRestart;
+
+			// A cache built with other options is rebuilt
+			const auto matchesOptions = [&]()
+			{
+				return mesh.quantizedVertices.empty() != options.quantize
+					&& mesh.primitiveTopology == topology
+					&& mesh.primitiveRestart == primitiveRestart
+					&& mesh.lods.empty() != options.generateLODs
+					&& mesh.meshlets.empty() != options.buildMeshlets;
+			};
+
+			if (Read(cachePath, objPath, mesh) && matchesOptions()) return true;
+
+			if (!Utils::ParseOBJ(objPath, mesh.vertices, mesh.indices)) return false;
+
+			MeshOptimizer::OptimizeVertexCache(mesh.indices, mesh.vertices.size());
+
+			mesh.bounds = Bounds::FromVertices(mesh.vertices);
+
+			const Vector3 extent = mesh.bounds.max - mesh.bounds.min;
+			const float maxError = std::max({ extent.x, extent.y, extent.z }) * MAX_LOD_ERROR;
+
+			// Full detail first, every next level simplified from the previous one
+			std::vector<std::vector<uint32_t>> levels{};
+			std::vector<float> errors{ 0.0f };
+			levels.push_back(std::move(mesh.indices));
+
+			while (options.generateLODs && levels.size() < MAX_LOD_COUNT && levels.back().size() / 3 > MIN_LOD_TRIANGLES)
+			{
+				float error;
+				std::vector<uint32_t> simplified = MeshOptimizer::Simplify(mesh.vertices, levels.back(), levels.back().size() / 2, maxError, error);
+				if (simplified.size() > levels.back().size() * 4 / 5) break;
+
+				MeshOptimizer::OptimizeVertexCache(simplified, mesh.vertices.size());
+				errors.push_back(errors.back() + error);
+				levels.push_back(std::move(simplified));
+			}
+
+			// Levels are stored coarsest first, so ordering the vertices by first use gives every level a prefix of the vertex buffer
+			mesh.indices.clear();
+			mesh.lods.assign(levels.size(), MeshLOD{});
+			mesh.meshlets.clear();
+
+			for (size_t level = levels.size(); level-- > 0;)
+			{
+				MeshLOD& lod = mesh.lods[level];
+				lod.indexOffset = static_cast<uint32_t>(mesh.indices.size());
+				lod.error = errors[level];
+
+				if (options.buildMeshlets)
+				{
+					// Every meshlet is stripified on its own, so it can be drawn without the others
+					lod.meshletOffset = static_cast<uint32_t>(mesh.meshlets.size());
+
+					// Reorders the triangles of the level so every meshlet is a consecutive range
+					const std::vector<Meshlet> meshlets = MeshOptimizer::BuildMeshlets(mesh.vertices, levels[level]);
+
+					for (Meshlet meshlet : meshlets)
+					{
+						const auto first = levels[level].begin() + meshlet.indexOffset;
+						std::vector<uint32_t> range(first, first + meshlet.indexCount);
+						if (options.stripify) range = MeshOptimizer::Stripify(range, primitiveRestart);
+
+						meshlet.indexOffset = static_cast<uint32_t>(mesh.indices.size());
+						meshlet.indexCount = static_cast<uint32_t>(range.size());
+						mesh.indices.insert(mesh.indices.end(), range.begin(), range.end());
+						mesh.meshlets.push_back(meshlet);
+					}
+
+					lod.meshletCount = static_cast<uint32_t>(mesh.meshlets.size()) - lod.meshletOffset;
+				}
+				else
+				{
+					if (options.stripify) levels[level] = MeshOptimizer::Stripify(levels[level], primitiveRestart);
+					mesh.indices.insert(mesh.indices.end(), levels[level].begin(), levels[level].end());
+				}
+
+				lod.indexCount = static_cast<uint32_t>(mesh.indices.size()) - lod.indexOffset;
+			}
+
+			MeshOptimizer::OptimizeVertexFetch(mesh.vertices, mesh.indices);
+			FillMeshletVertices(mesh);
+
+			for (MeshLOD& lod : mesh.lods)
+			{
+				for (uint32_t i = lod.indexOffset; i < lod.indexOffset + lod.indexCount; ++i)
+				{
+					if (mesh.indices[i] != PRIMITIVE_RESTART_INDEX<uint32_t>) lod.vertexCount = std::max(lod.vertexCount, mesh.indices[i] + 1);
+				}
+			}
+
+			if (!options.generateLODs) mesh.lods.clear();
+
+			mesh.primitiveTopology = topology;
+			mesh.primitiveRestart = primitiveRestart;
+
+			mesh.quantizedVertices.clear();
+			mesh.indices16.clear();
+			if (options.quantize) Quantization::QuantizeMesh(mesh);
+
+			// Failing to write the cache only costs the next run a reparse
+			Write(cachePath, objPath, mesh);
+
+			return true;
+		}
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+
+#include "DataTypes.h"
+
+namespace dae
+{
+	// Preprocessed binary meshes, stored next to their source OBJ so later runs skip parsing and optimizing
+	namespace MeshCache
+	{
+		// Path of the cache file belonging to a source file ("Resources/vehicle.obj" -> "Resources/vehicle.mesh")
+		std::string GetCachePath(const std::string& sourcePath);
+
+		// Writes the vertices, indices, topology, bounds, LOD chain and meshlets of the mesh, stamped with the current size and time of the source file
+		// Quantized meshes are stored compressed with MeshCodec, float meshes are stored raw
+		bool Write(const std::string& cachePath, const std::string& sourcePath, const Mesh& mesh);
+
+		// Fails when the file is missing, of another version or vertex layout, or older than its source file
+		bool Read(const std::string& cachePath, const std::string& sourcePath, Mesh& mesh);
+
+		struct LoadOptions
+		{
+			// Quantized vertex encoding, stored compressed in the cache
+			bool quantize{ false };
+			// Triangle strips (PrimitiveTopology::TriangleStrip) instead of a triangle list
+			bool stripify{ false };
+			// Strips separated by restart indices instead of degenerate triangles, only used with stripify
+			bool primitiveRestart{ false };
+			// Chain of simplified levels of detail in Mesh::lods, stored with the mesh in the cache
+			bool generateLODs{ false };
+			// Clusters in Mesh::meshlets for culling before the vertex stage, strips restart at every cluster
+			bool buildMeshlets{ false };
+		};
+
+		// Reads the cache when it is up to date, otherwise parses and optimizes the OBJ and writes a new cache
+		bool LoadOBJ(const std::string& objPath, Mesh& mesh, const LoadOptions& options = {});
+	}
+}
@@ -0,0 +1,229 @@
+#include "MeshCodec.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <execution>
+#include <ranges>
+
+namespace dae
+{
+	namespace MeshCodec
+	{
+		namespace
+		{
+			// Elements per independently decodable block
+			constexpr size_t BLOCK_SIZE{ 4096 };
+
+			// Components of QuantizedVertex in stream order
+			constexpr size_t VERTEX_COMPONENTS{ 13 };
+
+			// Blob layout: StreamHeader, uint64 block end offsets, block data
+			struct StreamHeader
+			{
+				uint64_t elementCount;
+				uint32_t stride;
+				uint32_t blockCount;
+			};
+
+			// Residuals wrap around like unsigned arithmetic, so any pair of 32-bit values round-trips
+			int32_t Subtract(int32_t a, int32_t b)
+			{
+				return static_cast<int32_t>(static_cast<uint32_t>(a) - static_cast<uint32_t>(b));
+			}
+
+			int32_t Add(int32_t a, int32_t b)
+			{
+				return static_cast<int32_t>(static_cast<uint32_t>(a) + static_cast<uint32_t>(b));
+			}
+
+			uint32_t ZigZag(int32_t value)
+			{
+				return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+			}
+
+			int32_t UnZigZag(uint32_t value)
+			{
+				return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+			}
+
+			void WriteVarint(std::vector<uint8_t>& out, uint32_t value)
+			{
+				while (value >= 0x80)
+				{
+					out.push_back(static_cast<uint8_t>(value | 0x80));
+					value >>= 7;
+				}
+				out.push_back(static_cast<uint8_t>(value));
+			}
+
+			bool ReadVarint(const uint8_t*& it, const uint8_t* end, uint32_t& value)
+			{
+				value = 0;
+				for (int shift = 0; shift < 35 && it != end; shift += 7)
+				{
+					const uint8_t byte = *it++;
+					value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+					if ((byte & 0x80) == 0) return true;
+				}
+				return false;
+			}
+
+			// values holds elementCount * stride components, each component is predicted from the same component of the previous element
+			std::vector<uint8_t> EncodeStream(const std::vector<int32_t>& values, uint32_t stride)
+			{
+				const size_t elementCount = values.size() / stride;
+				const size_t blockCount = (elementCount + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+				std::vector<std::vector<uint8_t>> blocks(blockCount);
+				const auto blockRange = std::views::iota(size_t{ 0 }, blockCount);
+
+				std::for_each(std::execution::par, blockRange.begin(), blockRange.end(), [&](size_t block)
+				{
+					const size_t first = block * BLOCK_SIZE * stride;
+					const size_t last = std::min(values.size(), first + BLOCK_SIZE * stride);
+
+					for (size_t i = first; i < last; ++i)
+					{
+						const int32_t prediction = (i - first >= stride) ? values[i - stride] : 0;
+						WriteVarint(blocks[block], ZigZag(Subtract(values[i], prediction)));
+					}
+				});
+
+				const StreamHeader header{ elementCount, stride, static_cast<uint32_t>(blockCount) };
+
+				std::vector<uint8_t> out(sizeof(StreamHeader) + blockCount * sizeof(uint64_t));
+				std::memcpy(out.data(), &header, sizeof(StreamHeader));
+
+				for (size_t block = 0; block < blockCount; ++block)
+				{
+					out.insert(out.end(), blocks[block].begin(), blocks[block].end());
+
+					const uint64_t blockEnd = out.size();
+					std::memcpy(out.data() + sizeof(StreamHeader) + block * sizeof(uint64_t), &blockEnd, sizeof(uint64_t));
+				}
+
+				return out;
+			}
+
+			bool DecodeStream(const uint8_t* pData, size_t size, uint32_t stride, std::vector<int32_t>& values)
+			{
+				if (size < sizeof(StreamHeader)) return false;
+
+				StreamHeader header;
+				std::memcpy(&header, pData, sizeof(StreamHeader));
+
+				const size_t tableEnd = sizeof(StreamHeader) + header.blockCount * sizeof(uint64_t);
+				if (header.stride != stride || tableEnd > size) return false;
+				if (header.blockCount != (header.elementCount + BLOCK_SIZE - 1) / BLOCK_SIZE) return false;
+
+				// Every component takes at least one byte
+				if (header.elementCount * stride > size) return false;
+
+				std::vector<uint64_t> blockEnds(header.blockCount);
+				std::memcpy(blockEnds.data(), pData + sizeof(StreamHeader), header.blockCount * sizeof(uint64_t));
+
+				values.resize(header.elementCount * stride);
+
+				std::atomic<bool> isValid{ true };
+				const auto blockRange = std::views::iota(size_t{ 0 }, size_t{ header.blockCount });
+
+				std::for_each(std::execution::par, blockRange.begin(), blockRange.end(), [&](size_t block)
+				{
+					const uint64_t begin = (block == 0) ? tableEnd : blockEnds[block - 1];
+					const uint64_t end = blockEnds[block];
+
+					if (begin > end || end > size)
+					{
+						isValid = false;
+						return;
+					}
+
+					const uint8_t* it = pData + begin;
+					const size_t first = block * BLOCK_SIZE * stride;
+					const size_t last = std::min(values.size(), first + BLOCK_SIZE * stride);
+
+					for (size_t i = first; i < last; ++i)
+					{
+						uint32_t residual;
+						if (!ReadVarint(it, pData + end, residual))
+						{
+							isValid = false;
+							return;
+						}
+
+						const int32_t prediction = (i - first >= stride) ? values[i - stride] : 0;
+						values[i] = Add(prediction, UnZigZag(residual));
+					}
+				});
+
+				return isValid;
+			}
+		}
+
+		std::vector<uint8_t> EncodeIndices(const std::vector<uint32_t>& indices)
+		{
+			// Indices of an optimized mesh stay close to each other, so each one is predicted from the previous index
+			return EncodeStream(std::vector<int32_t>(indices.begin(), indices.end()), 1);
+		}
+
+		bool DecodeIndices(const uint8_t* pData, size_t size, std::vector<uint32_t>& indices)
+		{
+			std::vector<int32_t> values;
+			if (!DecodeStream(pData, size, 1, values)) return false;
+
+			indices.assign(values.begin(), values.end());
+			return true;
+		}
+
+		std::vector<uint8_t> EncodeVertices(const std::vector<QuantizedVertex>& vertices)
+		{
+			// After OptimizeVertexFetch neighbouring vertices are close in space, so every component is predicted from the previous vertex
+			std::vector<int32_t> values;
+			values.reserve(vertices.size() * VERTEX_COMPONENTS);
+
+			for (const QuantizedVertex& vertex : vertices)
+			{
+				values.insert(values.end(), {
+					vertex.position[0], vertex.position[1], vertex.position[2],
+					vertex.uv[0], vertex.uv[1],
+					vertex.normal[0], vertex.normal[1],
+					vertex.tangent[0], vertex.tangent[1],
+					vertex.color[0], vertex.color[1], vertex.color[2], vertex.color[3]
+				});
+			}
+
+			return EncodeStream(values, VERTEX_COMPONENTS);
+		}
+
+		bool DecodeVertices(const uint8_t* pData, size_t size, std::vector<QuantizedVertex>& vertices)
+		{
+			std::vector<int32_t> values;
+			if (!DecodeStream(pData, size, VERTEX_COMPONENTS, values)) return false;
+
+			vertices.resize(values.size() / VERTEX_COMPONENTS);
+
+			for (size_t i = 0; i < vertices.size(); ++i)
+			{
+				const int32_t* pValues = &values[i * VERTEX_COMPONENTS];
+				QuantizedVertex& vertex = vertices[i];
+
+				vertex.position[0] = static_cast<uint16_t>(pValues[0]);
+				vertex.position[1] = static_cast<uint16_t>(pValues[1]);
+				vertex.position[2] = static_cast<uint16_t>(pValues[2]);
+				vertex.uv[0] = static_cast<uint16_t>(pValues[3]);
+				vertex.uv[1] = static_cast<uint16_t>(pValues[4]);
+				vertex.normal[0] = static_cast<int16_t>(pValues[5]);
+				vertex.normal[1] = static_cast<int16_t>(pValues[6]);
+				vertex.tangent[0] = static_cast<int16_t>(pValues[7]);
+				vertex.tangent[1] = static_cast<int16_t>(pValues[8]);
+				vertex.color[0] = static_cast<uint8_t>(pValues[9]);
+				vertex.color[1] = static_cast<uint8_t>(pValues[10]);
+				vertex.color[2] = static_cast<uint8_t>(pValues[11]);
+				vertex.color[3] = static_cast<uint8_t>(pValues[12]);
+			}
+
+			return true;
+		}
+	}
+}
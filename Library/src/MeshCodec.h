@@ -0,0 +1,20 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "DataTypes.h"
+
+namespace dae
+{
+	// Lossless compression of (quantized) geometry streams for the on-disk mesh format
+	// Every element is predicted from the previous one, the residual is zigzag + varint coded
+	// Streams are cut in independent blocks, so decoding runs in parallel
+	namespace MeshCodec
+	{
+		std::vector<uint8_t> EncodeIndices(const std::vector<uint32_t>& indices);
+		bool DecodeIndices(const uint8_t* pData, size_t size, std::vector<uint32_t>& indices);
+
+		std::vector<uint8_t> EncodeVertices(const std::vector<QuantizedVertex>& vertices);
+		bool DecodeVertices(const uint8_t* pData, size_t size, std::vector<QuantizedVertex>& vertices);
+	}
+}
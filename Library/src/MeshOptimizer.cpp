@@ -0,0 +1,903 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace dae
+{
+	namespace MeshOptimizer
+	{
+		float CalculateACMR(const std::vector<uint32_t>& indices, size_t vertexCount, size_t cacheSize)
+		{
+			if (indices.size() < 3) return 0.0f;
+
+			// Timestamp based FIFO: a vertex is cached when it entered less than cacheSize misses ago
+			std::vector<size_t> entered(vertexCount, 0);
+			size_t misses{};
+
+			for (uint32_t index : indices)
+			{
+				if (entered[index] == 0 || misses - entered[index] >= cacheSize)
+				{
+					++misses;
+					entered[index] = misses;
+				}
+			}
+
+			return static_cast<float>(misses) / (indices.size() / 3);
+		}
+
+		// --- Forsyth, "Linear-Speed Vertex Cache Optimisation" ---
+		namespace
+		{
+			constexpr int CACHE_SIZE{ 32 };
+			constexpr float CACHE_DECAY_POWER{ 1.5f };
+			constexpr float LAST_TRIANGLE_SCORE{ 0.75f };
+			constexpr float VALENCE_BOOST_SCALE{ 2.0f };
+			constexpr float VALENCE_BOOST_POWER{ 0.5f };
+
+			float CalculateVertexScore(int cachePosition, uint32_t remainingTriangles)
+			{
+				// No triangles left means the vertex is never needed again
+				if (remainingTriangles == 0) return -1.0f;
+
+				float score{};
+
+				if (cachePosition >= 0)
+				{
+					if (cachePosition < 3)
+					{
+						// Used by the last triangle, a fixed score avoids favoring one of its edges
+						score = LAST_TRIANGLE_SCORE;
+					}
+					else
+					{
+						const float scaler = 1.0f / (CACHE_SIZE - 3);
+						score = std::pow(1.0f - (cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+					}
+				}
+
+				// Boost vertices with few triangles left, so lone triangles get picked before they are stranded
+				score += VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER);
+
+				return score;
+			}
+		}
+
+		void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount)
+		{
+			assert(indices.size() % 3 == 0 && "incomplete triangles");
+
+			const size_t triangleCount = indices.size() / 3;
+			if (triangleCount == 0) return;
+
+			// Vertex -> triangle adjacency (compressed rows)
+			std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+			for (uint32_t index : indices) ++adjacencyOffsets[index + 1];
+			for (size_t i = 1; i < adjacencyOffsets.size(); ++i) adjacencyOffsets[i] += adjacencyOffsets[i - 1];
+
+			std::vector<uint32_t> adjacency(indices.size());
+			std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (size_t i = 0; i < indices.size(); ++i) adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+
+			// Per-vertex state, the remaining triangles are kept at the front of each adjacency row
+			std::vector<uint32_t> remainingTriangles(vertexCount);
+			std::vector<float> vertexScores(vertexCount);
+
+			for (size_t v = 0; v < vertexCount; ++v)
+			{
+				remainingTriangles[v] = adjacencyOffsets[v + 1] - adjacencyOffsets[v];
+				vertexScores[v] = CalculateVertexScore(-1, remainingTriangles[v]);
+			}
+
+			std::vector<bool> isEmitted(triangleCount, false);
+
+			std::vector<uint32_t> optimized{};
+			optimized.reserve(indices.size());
+
+			// Cache holds CACHE_SIZE entries plus room for the 3 vertices pushed in front before trimming
+			std::vector<uint32_t> cache{};
+			std::vector<uint32_t> nextCache{};
+			cache.reserve(CACHE_SIZE + 3);
+			nextCache.reserve(CACHE_SIZE + 3);
+
+			size_t scanCursor{};
+			size_t bestTriangle{ triangleCount };
+
+			for (size_t emitted = 0; emitted < triangleCount; ++emitted)
+			{
+				// No candidate touches the cache, continue with the first remaining triangle
+				if (bestTriangle == triangleCount)
+				{
+					while (isEmitted[scanCursor]) ++scanCursor;
+					bestTriangle = scanCursor;
+				}
+
+				const uint32_t* pTriangle = &indices[bestTriangle * 3];
+				optimized.insert(optimized.end(), pTriangle, pTriangle + 3);
+				isEmitted[bestTriangle] = true;
+
+				// Remove the triangle from the remaining triangles of its vertices
+				for (int i = 0; i < 3; ++i)
+				{
+					const uint32_t v = pTriangle[i];
+					uint32_t* pBegin = &adjacency[adjacencyOffsets[v]];
+					uint32_t* pEnd = pBegin + remainingTriangles[v];
+
+					std::iter_swap(std::find(pBegin, pEnd, static_cast<uint32_t>(bestTriangle)), pEnd - 1);
+					--remainingTriangles[v];
+				}
+
+				// LRU update: the triangle's vertices move to the front
+				nextCache.assign(pTriangle, pTriangle + 3);
+				for (uint32_t v : cache)
+				{
+					if (v != pTriangle[0] && v != pTriangle[1] && v != pTriangle[2]) nextCache.push_back(v);
+				}
+				std::swap(cache, nextCache);
+
+				// Rescore everything in the (oversized) cache, evicted vertices lose their cache bonus
+				for (size_t i = 0; i < cache.size(); ++i)
+				{
+					const uint32_t v = cache[i];
+					const int position = (i < CACHE_SIZE) ? static_cast<int>(i) : -1;
+
+					vertexScores[v] = CalculateVertexScore(position, remainingTriangles[v]);
+				}
+
+				// The next triangle is the best one touching the cache
+				bestTriangle = triangleCount;
+				float bestScore{ -1.0f };
+
+				for (uint32_t v : cache)
+				{
+					for (uint32_t i = 0; i < remainingTriangles[v]; ++i)
+					{
+						const uint32_t t = adjacency[adjacencyOffsets[v] + i];
+						const float score = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+
+						if (score > bestScore)
+						{
+							bestScore = score;
+							bestTriangle = t;
+						}
+					}
+				}
+
+				if (cache.size() > CACHE_SIZE) cache.resize(CACHE_SIZE);
+			}
+
+			indices = std::move(optimized);
+		}
+
+		namespace
+		{
+			// Vertices split along uv/normal seams share a position, every vertex gets the first vertex with its position as group
+			std::vector<uint32_t> GroupByPosition(const std::vector<Vertex>& vertices)
+			{
+				using Key = std::array<uint32_t, 3>;
+
+				struct KeyHash
+				{
+					size_t operator()(const Key& key) const
+					{
+						return (static_cast<size_t>(key[0]) * 73856093u) ^ (static_cast<size_t>(key[1]) * 19349663u) ^ (static_cast<size_t>(key[2]) * 83492791u);
+					}
+				};
+
+				std::vector<uint32_t> groups(vertices.size());
+
+				std::unordered_map<Key, uint32_t, KeyHash> lookup{};
+				lookup.reserve(vertices.size());
+
+				for (uint32_t v = 0; v < vertices.size(); ++v)
+				{
+					Key key;
+					std::memcpy(key.data(), &vertices[v].position, sizeof(Key));
+
+					groups[v] = lookup.try_emplace(key, v).first->second;
+				}
+
+				return groups;
+			}
+		}
+
+		// --- Garland & Heckbert, "Surface Simplification Using Quadric Error Metrics" ---
+		namespace
+		{
+			// Border edges are kept in place by planes through the edge, perpendicular to its triangle
+			constexpr double BORDER_WEIGHT{ 10.0 };
+
+			// Sum of squared distances to a set of planes, weighted by triangle area
+			struct Quadric
+			{
+				double a00, a11, a22, a10, a20, a21;
+				double b0, b1, b2;
+				double c;
+				double weight;
+			};
+
+			void AddPlane(Quadric& quadric, const Vector3& normal, float distance, double weight)
+			{
+				const double a = normal.x, b = normal.y, c = normal.z, d = distance;
+
+				quadric.a00 += weight * a * a;
+				quadric.a11 += weight * b * b;
+				quadric.a22 += weight * c * c;
+				quadric.a10 += weight * a * b;
+				quadric.a20 += weight * a * c;
+				quadric.a21 += weight * b * c;
+				quadric.b0 += weight * a * d;
+				quadric.b1 += weight * b * d;
+				quadric.b2 += weight * c * d;
+				quadric.c += weight * d * d;
+				quadric.weight += weight;
+			}
+
+			Quadric AddQuadrics(const Quadric& q0, const Quadric& q1)
+			{
+				return {
+					q0.a00 + q1.a00, q0.a11 + q1.a11, q0.a22 + q1.a22, q0.a10 + q1.a10, q0.a20 + q1.a20, q0.a21 + q1.a21,
+					q0.b0 + q1.b0, q0.b1 + q1.b1, q0.b2 + q1.b2,
+					q0.c + q1.c,
+					q0.weight + q1.weight
+				};
+			}
+
+			// Mean squared distance of the point to the planes of the quadric
+			double EvaluateQuadric(const Quadric& quadric, const Vector3& point)
+			{
+				if (quadric.weight <= 0.0) return 0.0;
+
+				const double x = point.x, y = point.y, z = point.z;
+
+				const double error =
+					quadric.a00 * x * x + quadric.a11 * y * y + quadric.a22 * z * z +
+					2.0 * (quadric.a10 * x * y + quadric.a20 * x * z + quadric.a21 * y * z) +
+					2.0 * (quadric.b0 * x + quadric.b1 * y + quadric.b2 * z) +
+					quadric.c;
+
+				return std::abs(error) / quadric.weight;
+			}
+
+			uint64_t EdgeKey(uint32_t a, uint32_t b)
+			{
+				return (static_cast<uint64_t>(a) << 32) | b;
+			}
+
+			struct Collapse
+			{
+				uint32_t from;
+				uint32_t to;
+				double error;
+			};
+		}
+
+		std::vector<uint32_t> Simplify(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, size_t targetIndexCount, float maxError, float& error)
+		{
+			assert(indices.size() % 3 == 0 && "incomplete triangles");
+
+			error = 0.0f;
+
+			std::vector<uint32_t> result = indices;
+			if (result.size() <= targetIndexCount) return result;
+
+			// Collapses move whole position groups
+			const std::vector<uint32_t> groups = GroupByPosition(vertices);
+
+			// Triangles without area in position space are dropped up front
+			const auto removeDegenerates = [&](const std::vector<uint32_t>& remap)
+			{
+				size_t writeIndex{};
+				for (size_t i = 0; i < result.size(); i += 3)
+				{
+					const uint32_t v0 = remap[result[i]];
+					const uint32_t v1 = remap[result[i + 1]];
+					const uint32_t v2 = remap[result[i + 2]];
+
+					if (groups[v0] == groups[v1] || groups[v1] == groups[v2] || groups[v0] == groups[v2]) continue;
+
+					result[writeIndex++] = v0;
+					result[writeIndex++] = v1;
+					result[writeIndex++] = v2;
+				}
+				result.resize(writeIndex);
+			};
+
+			std::vector<uint32_t> remap(vertices.size());
+			std::iota(remap.begin(), remap.end(), 0);
+			removeDegenerates(remap);
+
+			const auto getPosition = [&](uint32_t vertex) -> const Vector3& { return vertices[vertex].position; };
+
+			std::vector<Quadric> quadrics(vertices.size(), Quadric{});
+
+			// Directed group edges of the triangles, an edge without its reverse is a border
+			std::unordered_set<uint64_t> edges{};
+
+			const auto collectEdges = [&]()
+			{
+				edges.clear();
+				for (size_t i = 0; i < result.size(); i += 3)
+				{
+					for (int k = 0; k < 3; ++k)
+					{
+						edges.insert(EdgeKey(groups[result[i + k]], groups[result[i + (k + 1) % 3]]));
+					}
+				}
+			};
+
+			const auto isBorderEdge = [&](uint32_t a, uint32_t b)
+			{
+				return edges.contains(EdgeKey(a, b)) != edges.contains(EdgeKey(b, a));
+			};
+
+			collectEdges();
+
+			for (size_t i = 0; i < result.size(); i += 3)
+			{
+				const Vector3& p0 = getPosition(result[i]);
+				const Vector3& p1 = getPosition(result[i + 1]);
+				const Vector3& p2 = getPosition(result[i + 2]);
+
+				Vector3 normal = Vector3::Cross(p1 - p0, p2 - p0);
+				const float doubleArea = normal.Normalize();
+				if (doubleArea == 0.0f) continue;
+
+				for (int k = 0; k < 3; ++k)
+				{
+					AddPlane(quadrics[groups[result[i + k]]], normal, -Vector3::Dot(normal, p0), doubleArea * 0.5);
+				}
+
+				for (int k = 0; k < 3; ++k)
+				{
+					const uint32_t a = groups[result[i + k]];
+					const uint32_t b = groups[result[i + (k + 1) % 3]];
+					if (!isBorderEdge(a, b)) continue;
+
+					const Vector3 edge = getPosition(b) - getPosition(a);
+					const Vector3 borderNormal = Vector3::Cross(edge, normal).Normalized();
+					const double weight = edge.SqrMagnitude() * BORDER_WEIGHT;
+
+					AddPlane(quadrics[a], borderNormal, -Vector3::Dot(borderNormal, getPosition(a)), weight);
+					AddPlane(quadrics[b], borderNormal, -Vector3::Dot(borderNormal, getPosition(a)), weight);
+				}
+			}
+
+			// Quadric errors are squared distances
+			const double errorLimit = static_cast<double>(maxError) * maxError;
+			double largestError{};
+
+			std::vector<uint32_t> adjacencyOffsets{};
+			std::vector<uint32_t> adjacency{};
+			std::vector<bool> isBorder(vertices.size());
+			std::vector<bool> isLocked(vertices.size());
+			std::vector<std::pair<uint32_t, uint32_t>> partners{};
+			std::vector<Collapse> collapses{};
+
+			// Each pass collapses the cheapest edges whose one-rings do not overlap, so every collapse sees up to date neighbours
+			while (result.size() > targetIndexCount)
+			{
+				const size_t triangleCount = result.size() / 3;
+
+				// Triangles around every group
+				adjacencyOffsets.assign(vertices.size() + 1, 0);
+				for (uint32_t index : result) ++adjacencyOffsets[groups[index] + 1];
+				std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+
+				adjacency.resize(result.size());
+				std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+				for (size_t i = 0; i < result.size(); ++i) adjacency[cursor[groups[result[i]]]++] = static_cast<uint32_t>(i / 3);
+
+				std::fill(isBorder.begin(), isBorder.end(), false);
+				for (size_t i = 0; i < result.size(); i += 3)
+				{
+					for (int k = 0; k < 3; ++k)
+					{
+						const uint32_t a = groups[result[i + k]];
+						const uint32_t b = groups[result[i + (k + 1) % 3]];
+						if (isBorderEdge(a, b)) isBorder[a] = isBorder[b] = true;
+					}
+				}
+
+				// Border groups only slide along their border, so open edges keep their outline
+				const auto canCollapse = [&](uint32_t from, uint32_t to)
+				{
+					return !isBorder[from] || isBorderEdge(from, to);
+				};
+
+				collapses.clear();
+				for (size_t i = 0; i < result.size(); i += 3)
+				{
+					for (int k = 0; k < 3; ++k)
+					{
+						const uint32_t a = groups[result[i + k]];
+						const uint32_t b = groups[result[i + (k + 1) % 3]];
+
+						// Interior edges are seen from both of their triangles, only one of them adds it
+						if (a > b && edges.contains(EdgeKey(b, a))) continue;
+
+						const Quadric quadric = AddQuadrics(quadrics[a], quadrics[b]);
+						const double errorAB = canCollapse(a, b) ? EvaluateQuadric(quadric, getPosition(b)) : DBL_MAX;
+						const double errorBA = canCollapse(b, a) ? EvaluateQuadric(quadric, getPosition(a)) : DBL_MAX;
+
+						if (errorAB == DBL_MAX && errorBA == DBL_MAX) continue;
+
+						if (errorAB <= errorBA) collapses.push_back({ a, b, errorAB });
+						else collapses.push_back({ b, a, errorBA });
+					}
+				}
+
+				if (collapses.empty()) break;
+
+				std::sort(collapses.begin(), collapses.end(), [](const Collapse& c0, const Collapse& c1)
+				{
+					return c0.error < c1.error;
+				});
+
+				std::fill(isLocked.begin(), isLocked.end(), false);
+				std::iota(remap.begin(), remap.end(), 0);
+
+				const size_t targetTriangleCount = targetIndexCount / 3;
+				size_t remainingTriangles = triangleCount;
+
+				// A collapse removes about two triangles, so only the cheapest candidates needed for the target are tried,
+				// invalid ones widen the window and locked ones wait for the next pass
+				size_t window = (triangleCount - targetTriangleCount) / 2 + 1;
+
+				for (size_t c = 0; c < std::min(window, collapses.size()); ++c)
+				{
+					const Collapse& collapse = collapses[c];
+
+					if (remainingTriangles <= targetTriangleCount || collapse.error > errorLimit) break;
+					if (isLocked[collapse.from] || isLocked[collapse.to]) continue;
+
+					const Vector3& target = getPosition(collapse.to);
+
+					// Every vertex of the moving group needs a vertex of the target group on a shared triangle to merge into,
+					// so the attributes on both sides of a seam stay valid
+					partners.clear();
+					size_t removedTriangles{};
+					bool isValid{ true };
+
+					for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1] && isValid; ++a)
+					{
+						const uint32_t* pTriangle = &result[adjacency[a] * 3];
+
+						int from{ -1 }, to{ -1 };
+						for (int k = 0; k < 3; ++k)
+						{
+							if (groups[pTriangle[k]] == collapse.from) from = k;
+							if (groups[pTriangle[k]] == collapse.to) to = k;
+						}
+
+						if (to >= 0)
+						{
+							partners.emplace_back(pTriangle[from], pTriangle[to]);
+							++removedTriangles;
+							continue;
+						}
+
+						// The remaining triangles must not flip when the vertex moves
+						Vector3 corners[3]{ getPosition(pTriangle[0]), getPosition(pTriangle[1]), getPosition(pTriangle[2]) };
+						const Vector3 normalBefore = Vector3::Cross(corners[1] - corners[0], corners[2] - corners[0]);
+						corners[from] = target;
+						const Vector3 normalAfter = Vector3::Cross(corners[1] - corners[0], corners[2] - corners[0]);
+
+						if (Vector3::Dot(normalBefore, normalAfter) <= 0.0f) isValid = false;
+					}
+
+					for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1] && isValid; ++a)
+					{
+						const uint32_t* pTriangle = &result[adjacency[a] * 3];
+						for (int k = 0; k < 3; ++k)
+						{
+							if (groups[pTriangle[k]] != collapse.from) continue;
+
+							const bool hasPartner = std::any_of(partners.begin(), partners.end(), [&](const auto& partner) { return partner.first == pTriangle[k]; });
+							if (!hasPartner) isValid = false;
+						}
+					}
+
+					if (!isValid)
+					{
+						++window;
+						continue;
+					}
+
+					for (const auto& [vertex, partner] : partners)
+					{
+						remap[vertex] = partner;
+					}
+
+					quadrics[collapse.to] = AddQuadrics(quadrics[collapse.to], quadrics[collapse.from]);
+					largestError = std::max(largestError, collapse.error);
+					remainingTriangles -= removedTriangles;
+
+					// The one-ring changed shape, its groups wait for the next pass
+					for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1]; ++a)
+					{
+						const uint32_t* pTriangle = &result[adjacency[a] * 3];
+						for (int k = 0; k < 3; ++k) isLocked[groups[pTriangle[k]]] = true;
+					}
+				}
+
+				if (remainingTriangles == triangleCount) break;
+
+				// Apply the collapses and drop the triangles that lost their area
+				removeDegenerates(remap);
+
+				collectEdges();
+			}
+
+			error = static_cast<float>(std::sqrt(largestError));
+			return result;
+		}
+
+		std::vector<uint32_t> Stripify(const std::vector<uint32_t>& indices, bool primitiveRestart)
+		{
+			assert(indices.size() % 3 == 0 && "incomplete triangles");
+
+			const size_t triangleCount = indices.size() / 3;
+
+			// Directed edge (a -> b) -> triangles that contain it in their winding order
+			const auto edgeKey = [](uint32_t a, uint32_t b) { return (static_cast<uint64_t>(a) << 32) | b; };
+
+			std::unordered_multimap<uint64_t, uint32_t> edgeTriangles{};
+			edgeTriangles.reserve(indices.size());
+
+			for (size_t t = 0; t < triangleCount; ++t)
+			{
+				const uint32_t* pTriangle = &indices[t * 3];
+				for (int i = 0; i < 3; ++i)
+				{
+					edgeTriangles.emplace(edgeKey(pTriangle[i], pTriangle[(i + 1) % 3]), static_cast<uint32_t>(t));
+				}
+			}
+
+			std::vector<bool> isUsed(triangleCount, false);
+
+			// Unused triangle containing directed edge (a -> b), or triangleCount
+			const auto findTriangle = [&](uint32_t a, uint32_t b) -> size_t
+			{
+				const auto [begin, end] = edgeTriangles.equal_range(edgeKey(a, b));
+				for (auto it = begin; it != end; ++it)
+				{
+					if (!isUsed[it->second]) return it->second;
+				}
+				return triangleCount;
+			};
+
+			const auto countUnusedNeighbours = [&](size_t triangle) -> size_t
+			{
+				const uint32_t* pTriangle = &indices[triangle * 3];
+
+				size_t count{};
+				for (int i = 0; i < 3; ++i)
+				{
+					if (findTriangle(pTriangle[(i + 1) % 3], pTriangle[i]) != triangleCount) ++count;
+				}
+				return count;
+			};
+
+			// Grows a strip from a rotation of the start triangle, the taken triangles are marked used
+			// The next triangle shares the last two strip vertices, its winding alternates with its position in the strip
+			const auto growStrip = [&](size_t start, int rotation, std::vector<uint32_t>& strip, std::vector<size_t>& taken)
+			{
+				const uint32_t* pTriangle = &indices[start * 3];
+
+				strip.assign({ pTriangle[rotation], pTriangle[(rotation + 1) % 3], pTriangle[(rotation + 2) % 3] });
+				taken.assign({ start });
+				isUsed[start] = true;
+
+				for (;;)
+				{
+					const size_t k = strip.size() - 2;
+					const uint32_t a = (k % 2 == 0) ? strip[k] : strip[k + 1];
+					const uint32_t b = (k % 2 == 0) ? strip[k + 1] : strip[k];
+
+					const size_t next = findTriangle(a, b);
+					if (next == triangleCount) break;
+
+					const uint32_t* pNext = &indices[next * 3];
+					strip.push_back(pNext[0] ^ pNext[1] ^ pNext[2] ^ a ^ b);
+					taken.push_back(next);
+					isUsed[next] = true;
+				}
+			};
+
+			// Start triangles are picked with the fewest unused neighbours first, so strips do not strand lone triangles
+			// Neighbour counts only decrease, stale bucket entries are skipped when popped
+			std::vector<size_t> buckets[4]{};
+			for (size_t t = triangleCount; t-- > 0;) buckets[countUnusedNeighbours(t)].push_back(t);
+
+			std::vector<uint32_t> strips{};
+			strips.reserve(triangleCount * 2);
+
+			std::vector<uint32_t> strip{}, bestStrip{};
+			std::vector<size_t> taken{}, bestTaken{};
+
+			for (;;)
+			{
+				size_t start{ triangleCount };
+				for (std::vector<size_t>& bucket : buckets)
+				{
+					while (!bucket.empty() && isUsed[bucket.back()]) bucket.pop_back();
+					if (!bucket.empty())
+					{
+						start = bucket.back();
+						break;
+					}
+				}
+
+				if (start == triangleCount) break;
+
+				// Keep the longest of the three possible starting rotations
+				bestStrip.clear();
+				for (int rotation = 0; rotation < 3; ++rotation)
+				{
+					growStrip(start, rotation, strip, taken);
+					for (size_t t : taken) isUsed[t] = false;
+
+					if (strip.size() > bestStrip.size())
+					{
+						std::swap(strip, bestStrip);
+						std::swap(taken, bestTaken);
+					}
+				}
+
+				for (size_t t : bestTaken) isUsed[t] = true;
+
+				for (size_t t : bestTaken)
+				{
+					const uint32_t* pTriangle = &indices[t * 3];
+					for (int i = 0; i < 3; ++i)
+					{
+						const size_t neighbour = findTriangle(pTriangle[(i + 1) % 3], pTriangle[i]);
+						if (neighbour != triangleCount) buckets[countUnusedNeighbours(neighbour)].push_back(neighbour);
+					}
+				}
+
+				// A restart index resets the winding, degenerate joins take two triangles plus one more when needed to start the strip at an even position
+				if (!strips.empty() && primitiveRestart)
+				{
+					strips.push_back(PRIMITIVE_RESTART_INDEX<uint32_t>);
+				}
+				else if (!strips.empty())
+				{
+					strips.push_back(strips.back());
+					strips.push_back(bestStrip.front());
+					if (strips.size() % 2 != 0) strips.push_back(bestStrip.front());
+				}
+
+				strips.insert(strips.end(), bestStrip.begin(), bestStrip.end());
+			}
+
+			return strips;
+		}
+
+		namespace
+		{
+			// Triangles joining a meshlet stay within about 25 degrees of its mean normal, hard surface meshes then give
+			// small meshlets, but tight cones that cull about a third of the triangles from any side
+			constexpr float MESHLET_MIN_NORMAL_DOT{ 0.9f };
+		}
+
+		std::vector<Meshlet> BuildMeshlets(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+		{
+			assert(indices.size() % 3 == 0 && "incomplete triangles");
+
+			const size_t triangleCount = indices.size() / 3;
+
+			// Unit normal of every triangle, zero for degenerate ones
+			std::vector<Vector3> triangleNormals(triangleCount);
+			for (size_t t = 0; t < triangleCount; ++t)
+			{
+				const Vector3& p0 = vertices[indices[t * 3]].position;
+				const Vector3 normal = Vector3::Cross(vertices[indices[t * 3 + 1]].position - p0, vertices[indices[t * 3 + 2]].position - p0);
+				if (normal.SqrMagnitude() > 0.0f) triangleNormals[t] = normal.Normalized();
+			}
+
+			// Triangles around every position (CSR), so meshlets grow across uv and normal seams
+			const std::vector<uint32_t> groups = GroupByPosition(vertices);
+
+			std::vector<uint32_t> adjacencyOffsets(vertices.size() + 1);
+			for (uint32_t index : indices) ++adjacencyOffsets[groups[index] + 1];
+			std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+
+			std::vector<uint32_t> adjacency(indices.size());
+			std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (size_t i = 0; i < indices.size(); ++i) adjacency[fill[groups[indices[i]]]++] = static_cast<uint32_t>(i / 3);
+
+			std::vector<Meshlet> meshlets{};
+			std::vector<uint32_t> orderedIndices{};
+			orderedIndices.reserve(indices.size());
+
+			std::vector<bool> isEmitted(triangleCount);
+			// Last meshlet each vertex was added to, so membership needs no clearing between meshlets
+			std::vector<uint32_t> owner(vertices.size(), UINT32_MAX);
+
+			std::vector<uint32_t> candidates{};
+			size_t nextSeed{};
+
+			while (orderedIndices.size() < indices.size())
+			{
+				const uint32_t meshletIndex = static_cast<uint32_t>(meshlets.size());
+
+				Meshlet meshlet{};
+				meshlet.indexOffset = static_cast<uint32_t>(orderedIndices.size());
+				size_t vertexCount{};
+				Vector3 normalSum{};
+
+				while (isEmitted[nextSeed]) ++nextSeed;
+				candidates.assign(1, static_cast<uint32_t>(nextSeed));
+
+				const auto countNewVertices = [&](uint32_t triangle)
+				{
+					size_t count{};
+					for (int k = 0; k < 3; ++k)
+					{
+						if (owner[indices[triangle * 3 + k]] != meshletIndex) ++count;
+					}
+					return count;
+				};
+
+				while (meshlet.indexCount / 3 < MESHLET_MAX_TRIANGLES)
+				{
+					// Grow along the surface: fewest new vertices first, then the normal closest to the meshlet
+					const Vector3 axis = (normalSum.SqrMagnitude() > 0.0f) ? normalSum.Normalized() : Vector3{};
+
+					size_t best{ candidates.size() };
+					size_t bestNewVertices{ SIZE_MAX };
+					float bestDot{ -FLT_MAX };
+
+					for (size_t c = 0; c < candidates.size(); ++c)
+					{
+						const uint32_t triangle = candidates[c];
+						if (isEmitted[triangle]) continue;
+
+						const size_t newVertices = countNewVertices(triangle);
+						if (vertexCount + newVertices > MESHLET_MAX_VERTICES) continue;
+
+						// Degenerate triangles have no normal and fit anywhere
+						const float dot = (axis.SqrMagnitude() > 0.0f && triangleNormals[triangle].SqrMagnitude() > 0.0f) ? Vector3::Dot(triangleNormals[triangle], axis) : 1.0f;
+						if (dot < MESHLET_MIN_NORMAL_DOT) continue;
+
+						if (newVertices < bestNewVertices || (newVertices == bestNewVertices && dot > bestDot))
+						{
+							best = c;
+							bestNewVertices = newVertices;
+							bestDot = dot;
+						}
+					}
+
+					if (best == candidates.size()) break;
+
+					const uint32_t triangle = candidates[best];
+					candidates[best] = candidates.back();
+					candidates.pop_back();
+
+					isEmitted[triangle] = true;
+					normalSum += triangleNormals[triangle];
+					meshlet.indexCount += 3;
+
+					for (int k = 0; k < 3; ++k)
+					{
+						const uint32_t index = indices[triangle * 3 + k];
+						orderedIndices.push_back(index);
+
+						if (owner[index] == meshletIndex) continue;
+
+						owner[index] = meshletIndex;
+						++vertexCount;
+
+						const uint32_t group = groups[index];
+						for (uint32_t a = adjacencyOffsets[group]; a < adjacencyOffsets[group + 1]; ++a)
+						{
+							if (!isEmitted[adjacency[a]]) candidates.push_back(adjacency[a]);
+						}
+					}
+
+					// Emitted and duplicate candidates are skipped, dropping them now and then keeps the scan short
+					if (candidates.size() > MESHLET_MAX_VERTICES * 8)
+					{
+						std::erase_if(candidates, [&](uint32_t candidate) { return isEmitted[candidate]; });
+						std::sort(candidates.begin(), candidates.end());
+						candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+					}
+				}
+
+				meshlets.push_back(meshlet);
+			}
+
+			indices = std::move(orderedIndices);
+
+			for (Meshlet& cluster : meshlets)
+			{
+				// Sphere around the center of the bounding box
+				Vector3 boundsMin{ FLT_MAX, FLT_MAX, FLT_MAX };
+				Vector3 boundsMax{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+				for (uint32_t i = cluster.indexOffset; i < cluster.indexOffset + cluster.indexCount; ++i)
+				{
+					boundsMin = Vector3::Min(boundsMin, vertices[indices[i]].position);
+					boundsMax = Vector3::Max(boundsMax, vertices[indices[i]].position);
+				}
+
+				cluster.center = (boundsMin + boundsMax) * 0.5f;
+				for (uint32_t i = cluster.indexOffset; i < cluster.indexOffset + cluster.indexCount; ++i)
+				{
+					cluster.radius = std::max(cluster.radius, (vertices[indices[i]].position - cluster.center).Magnitude());
+				}
+
+				// Cone axis along the area weighted mean normal, wide enough for the normal furthest from it
+				// The rasterizer draws both sides, so triangles wound against their vertex normals make the cluster unsafe to cull
+				Vector3 normals[MESHLET_MAX_TRIANGLES];
+				size_t normalCount{};
+				Vector3 axis{};
+				bool isWindingConsistent{ true };
+
+				for (uint32_t i = cluster.indexOffset; i < cluster.indexOffset + cluster.indexCount; i += 3)
+				{
+					const Vector3& p0 = vertices[indices[i]].position;
+					const Vector3& p1 = vertices[indices[i + 1]].position;
+					const Vector3& p2 = vertices[indices[i + 2]].position;
+
+					const Vector3 normal = Vector3::Cross(p1 - p0, p2 - p0);
+					if (normal.SqrMagnitude() == 0.0f) continue;
+
+					const Vector3 vertexNormal = vertices[indices[i]].normal + vertices[indices[i + 1]].normal + vertices[indices[i + 2]].normal;
+					if (Vector3::Dot(normal, vertexNormal) <= 0.0f) isWindingConsistent = false;
+
+					axis += normal;
+					normals[normalCount++] = normal.Normalized();
+				}
+
+				if (!isWindingConsistent || axis.SqrMagnitude() == 0.0f) continue;
+				axis.Normalize();
+
+				float minDot{ 1.0f };
+				for (size_t n = 0; n < normalCount; ++n)
+				{
+					minDot = std::min(minDot, Vector3::Dot(normals[n], axis));
+				}
+
+				// Normals more than 90 degrees apart face every direction, the cone cannot cull
+				cluster.coneAxis = axis;
+				cluster.coneCutoff = (minDot <= 0.0f) ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+			}
+
+			return meshlets;
+		}
+
+		void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+		{
+			constexpr uint32_t unused{ UINT32_MAX };
+
+			std::vector<uint32_t> remap(vertices.size(), unused);
+			std::vector<Vertex> ordered{};
+			ordered.reserve(vertices.size());
+
+			for (uint32_t& index : indices)
+			{
+				if (index == PRIMITIVE_RESTART_INDEX<uint32_t>) continue;
+
+				if (remap[index] == unused)
+				{
+					remap[index] = static_cast<uint32_t>(ordered.size());
+					ordered.push_back(vertices[index]);
+				}
+
+				index = remap[index];
+			}
+
+			vertices = std::move(ordered);
+		}
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "DataTypes.h"
+
+namespace dae
+{
+	namespace MeshOptimizer
+	{
+		constexpr size_t MESHLET_MAX_VERTICES{ 64 };
+		constexpr size_t MESHLET_MAX_TRIANGLES{ 124 };
+
+		// Average number of vertex transforms per triangle for a FIFO post-transform cache (1.0 is optimal for closed meshes, 3.0 is worst)
+		float CalculateACMR(const std::vector<uint32_t>& indices, size_t vertexCount, size_t cacheSize = 16);
+
+		// Reorders the triangles of an indexed triangle list for post-transform cache locality (Forsyth)
+		void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+		// Collapses edges of an indexed triangle list, cheapest quadric error first, until at most targetIndexCount indices remain
+		// or the next collapse would move the surface further than maxError (mesh units)
+		// Vertices keep their place and attributes, the result only references existing vertices
+		// error receives the estimated distance between the simplified and the original surface
+		std::vector<uint32_t> Simplify(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, size_t targetIndexCount, float maxError, float& error);
+
+		// Converts an indexed triangle list into triangle strips, joined by degenerate triangles into a single strip
+		// or, with primitiveRestart, separated by PRIMITIVE_RESTART_INDEX
+		// Winding follows Renderer::RasterizeTriangleStrip: odd triangles of a strip swap their first two vertices
+		std::vector<uint32_t> Stripify(const std::vector<uint32_t>& indices, bool primitiveRestart = false);
+
+		// Splits an indexed triangle list into meshlets of neighbouring triangles with similar normals, up to MESHLET_MAX_VERTICES vertices
+		// and MESHLET_MAX_TRIANGLES triangles each, with their bounding sphere and normal cone
+		// The triangles are reordered so every meshlet is a range of indices, the vertex ranges are left empty
+		// The cone stays disabled for meshlets with triangles wound against their vertex normals
+		std::vector<Meshlet> BuildMeshlets(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+		// Reorders the vertices in order of first use by the index buffer, unreferenced vertices are removed
+		// Primitive restart indices are left untouched
+		void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+	}
+}
@@ -0,0 +1,285 @@
+#include "OcclusionBuffer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <immintrin.h>
+
+namespace dae
+{
+	namespace
+	{
+		// Calls triangle(i0, i1, i2) for every triangle of a list or strip, winding does not matter for depth
+		template<typename Index, typename Triangle>
+		void ForEachTriangle(const Mesh& mesh, const Index* pIndices, uint32_t indexCount, Triangle&& triangle)
+		{
+			if (mesh.primitiveTopology == PrimitiveTopology::TriangleList)
+			{
+				for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+				{
+					triangle(pIndices[i], pIndices[i + 1], pIndices[i + 2]);
+				}
+				return;
+			}
+
+			size_t stripLength{};
+			for (uint32_t i = 0; i < indexCount; ++i)
+			{
+				if (mesh.primitiveRestart && pIndices[i] == PRIMITIVE_RESTART_INDEX<Index>)
+				{
+					stripLength = 0;
+					continue;
+				}
+
+				if (++stripLength < 3) continue;
+
+				const Index i0 = pIndices[i - 2];
+				const Index i1 = pIndices[i - 1];
+				const Index i2 = pIndices[i];
+
+				// Degenerate triangles only join strips
+				if (i0 != i1 && i1 != i2 && i0 != i2) triangle(i0, i1, i2);
+			}
+		}
+	}
+
+	OcclusionBuffer::OcclusionBuffer(int width, int height) :
+		m_Width{ width },
+		m_Height{ height },
+		m_Depth(static_cast<size_t>(width) * height, FLT_MAX),
+		m_Filtered(static_cast<size_t>(width) * height)
+	{
+		assert(width % 4 == 0 && "rows are rasterized 4 pixels at a time");
+	}
+
+	void OcclusionBuffer::Clear()
+	{
+		std::fill(m_Depth.begin(), m_Depth.end(), FLT_MAX);
+	}
+
+	void OcclusionBuffer::RasterizeOccluder(const Mesh& mesh, const Matrix& worldViewProjection)
+	{
+		// Coarser levels are not guaranteed to stay inside the full mesh, so only lods[0] is conservative
+		const bool isQuantized = !mesh.quantizedVertices.empty();
+		const size_t indexCount = mesh.indices16.empty() ? mesh.indices.size() : mesh.indices16.size();
+		const size_t vertexCount = isQuantized ? mesh.quantizedVertices.size() : mesh.vertices.size();
+		const MeshLOD lod = mesh.lods.empty()
+			? MeshLOD{ 0, static_cast<uint32_t>(indexCount), static_cast<uint32_t>(vertexCount) }
+			: mesh.lods[0];
+
+		m_Positions.resize(lod.vertexCount);
+
+		for (uint32_t i = 0; i < lod.vertexCount; ++i)
+		{
+			Vector3 position{};
+			if (isQuantized)
+			{
+				// Only the position of the quantized vertex is needed
+				const QuantizedVertex& vertex = mesh.quantizedVertices[i];
+				const QuantizationBox& box = mesh.quantizationBox;
+				position = {
+					box.offset.x + vertex.position[0] * box.scale.x,
+					box.offset.y + vertex.position[1] * box.scale.y,
+					box.offset.z + vertex.position[2] * box.scale.z
+				};
+			}
+			else
+			{
+				position = mesh.vertices[i].position;
+			}
+
+			m_Positions[i] = ToScreen(worldViewProjection.TransformPoint(Vector4{ position, 1.0f }));
+		}
+
+		const auto rasterize = [&](uint32_t i0, uint32_t i1, uint32_t i2)
+		{
+			RasterizeTriangle(m_Positions[i0], m_Positions[i1], m_Positions[i2]);
+		};
+
+		if (mesh.indices16.empty()) ForEachTriangle(mesh, mesh.indices.data() + lod.indexOffset, lod.indexCount, rasterize);
+		else ForEachTriangle(mesh, mesh.indices16.data() + lod.indexOffset, lod.indexCount, rasterize);
+	}
+
+	void OcclusionBuffer::Finalize()
+	{
+		// Separable 3x3 maximum, clamped at the borders since nothing outside the screen is visible anyway
+		for (int y = 0; y < m_Height; ++y)
+		{
+			const float* pRow = &m_Depth[static_cast<size_t>(y) * m_Width];
+			float* pFiltered = &m_Filtered[static_cast<size_t>(y) * m_Width];
+
+			for (int x = 0; x < m_Width; ++x)
+			{
+				pFiltered[x] = std::max({ pRow[std::max(x - 1, 0)], pRow[x], pRow[std::min(x + 1, m_Width - 1)] });
+			}
+		}
+
+		for (int y = 0; y < m_Height; ++y)
+		{
+			const float* pAbove = &m_Filtered[static_cast<size_t>(std::max(y - 1, 0)) * m_Width];
+			const float* pRow = &m_Filtered[static_cast<size_t>(y) * m_Width];
+			const float* pBelow = &m_Filtered[static_cast<size_t>(std::min(y + 1, m_Height - 1)) * m_Width];
+			float* pDepth = &m_Depth[static_cast<size_t>(y) * m_Width];
+
+			for (int x = 0; x < m_Width; ++x)
+			{
+				pDepth[x] = std::max({ pAbove[x], pRow[x], pBelow[x] });
+			}
+		}
+	}
+
+	bool OcclusionBuffer::IsBoxOccluded(const Vector3& min, const Vector3& max, const Matrix& viewProjection) const
+	{
+		float left{ FLT_MAX };
+		float top{ FLT_MAX };
+		float right{ -FLT_MAX };
+		float bottom{ -FLT_MAX };
+		float nearest{ FLT_MAX };
+
+		for (int corner = 0; corner < 8; ++corner)
+		{
+			const Vector4 clip = viewProjection.TransformPoint(Vector4{
+				(corner & 1) ? max.x : min.x,
+				(corner & 2) ? max.y : min.y,
+				(corner & 4) ? max.z : min.z,
+				1.0f
+			});
+
+			// Boxes reaching in front of the near plane cover the whole view
+			if (clip.z < 0.0f || clip.w <= 0.0f) return false;
+
+			const Vector4 screen = ToScreen(clip);
+			left = std::min(left, screen.x);
+			top = std::min(top, screen.y);
+			right = std::max(right, screen.x);
+			bottom = std::max(bottom, screen.y);
+			nearest = std::min(nearest, screen.z);
+		}
+
+		const int boxLeft = std::max(0, static_cast<int>(std::floor(left)));
+		const int boxTop = std::max(0, static_cast<int>(std::floor(top)));
+		const int boxRight = std::min(m_Width - 1, static_cast<int>(std::floor(right)));
+		const int boxBottom = std::min(m_Height - 1, static_cast<int>(std::floor(bottom)));
+
+		// Off screen boxes are left to frustum culling
+		if (boxLeft > boxRight || boxTop > boxBottom) return false;
+
+		for (int y = boxTop; y <= boxBottom; ++y)
+		{
+			const float* pRow = &m_Depth[static_cast<size_t>(y) * m_Width];
+
+			for (int x = boxLeft; x <= boxRight; ++x)
+			{
+				if (pRow[x] >= nearest) return false;
+			}
+		}
+
+		return true;
+	}
+
+	int OcclusionBuffer::GetWidth() const
+	{
+		return m_Width;
+	}
+
+	int OcclusionBuffer::GetHeight() const
+	{
+		return m_Height;
+	}
+
+	float OcclusionBuffer::GetDepth(int x, int y) const
+	{
+		return m_Depth[static_cast<size_t>(y) * m_Width + x];
+	}
+
+	void OcclusionBuffer::RasterizeTriangle(const Vector4& v0, const Vector4& v1, const Vector4& v2)
+	{
+		if (v0.w < 0.0f || v1.w < 0.0f || v2.w < 0.0f) return;
+
+		// Same edges and weights as Renderer::RasterizeTriangle
+		const Vector2 e0 = (v1 - v0).GetXY();
+		const Vector2 e1 = (v2 - v1).GetXY();
+		const Vector2 e2 = (v0 - v2).GetXY();
+
+		const float totalWeight = Vector2::Cross(e0, -e2);
+		if (totalWeight == 0.0f) return;
+
+		const float invTotalWeight = 1.0f / totalWeight;
+
+		// Bounding box, widened to whole groups of 4 pixels
+		int boxLeft		= static_cast<int>(std::min({ v0.x, v1.x, v2.x })) - 1;
+		int boxTop		= static_cast<int>(std::min({ v0.y, v1.y, v2.y })) - 1;
+		int boxRight	= static_cast<int>(std::max({ v0.x, v1.x, v2.x })) + 1;
+		int boxBottom	= static_cast<int>(std::max({ v0.y, v1.y, v2.y })) + 1;
+
+		boxLeft			= std::max(0, boxLeft) & ~3;
+		boxTop			= std::max(0, boxTop);
+		boxRight		= std::min(m_Width, (boxRight + 3) & ~3);
+		boxBottom		= std::min(m_Height, boxBottom);
+
+		if (boxLeft >= boxRight || boxTop >= boxBottom) return;
+
+		// The weights are affine in the pixel position, w0 = Cross(e1, pixel - v1) changes by -e1.y per pixel to the right
+		const float stepW0 = -e1.y * invTotalWeight;
+		const float stepW1 = -e2.y * invTotalWeight;
+		const float stepW2 = -e0.y * invTotalWeight;
+
+		// z / w is affine in screen space, so depth is interpolated linearly instead of through reciprocals
+		const float stepZ = stepW0 * v0.z + stepW1 * v1.z + stepW2 * v2.z;
+
+		const __m128 lanes = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 stepW0x4 = _mm_set1_ps(4.0f * stepW0);
+		const __m128 stepW1x4 = _mm_set1_ps(4.0f * stepW1);
+		const __m128 stepW2x4 = _mm_set1_ps(4.0f * stepW2);
+		const __m128 stepZx4 = _mm_set1_ps(4.0f * stepZ);
+
+		for (int py = boxTop; py < boxBottom; ++py)
+		{
+			const Vector2 pixel{ boxLeft + 0.5f, py + 0.5f };
+
+			const float w0 = Vector2::Cross(e1, pixel - v1.GetXY()) * invTotalWeight;
+			const float w1 = Vector2::Cross(e2, pixel - v2.GetXY()) * invTotalWeight;
+			const float w2 = Vector2::Cross(e0, pixel - v0.GetXY()) * invTotalWeight;
+			const float z = w0 * v0.z + w1 * v1.z + w2 * v2.z;
+
+			__m128 weight0 = _mm_add_ps(_mm_set1_ps(w0), _mm_mul_ps(lanes, _mm_set1_ps(stepW0)));
+			__m128 weight1 = _mm_add_ps(_mm_set1_ps(w1), _mm_mul_ps(lanes, _mm_set1_ps(stepW1)));
+			__m128 weight2 = _mm_add_ps(_mm_set1_ps(w2), _mm_mul_ps(lanes, _mm_set1_ps(stepW2)));
+			__m128 depth = _mm_add_ps(_mm_set1_ps(z), _mm_mul_ps(lanes, _mm_set1_ps(stepZ)));
+
+			float* pRow = &m_Depth[static_cast<size_t>(py) * m_Width];
+
+			for (int px = boxLeft; px < boxRight; px += 4)
+			{
+				// Inside all three edges and within the depth range, like the per pixel tests of the renderer
+				__m128 mask = _mm_and_ps(_mm_cmpge_ps(weight0, zero), _mm_cmpge_ps(weight1, zero));
+				mask = _mm_and_ps(mask, _mm_cmpge_ps(weight2, zero));
+				mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(depth, zero), _mm_cmple_ps(depth, one)));
+
+				const __m128 stored = _mm_loadu_ps(pRow + px);
+				const __m128 closest = _mm_min_ps(stored, depth);
+				_mm_storeu_ps(pRow + px, _mm_or_ps(_mm_and_ps(mask, closest), _mm_andnot_ps(mask, stored)));
+
+				weight0 = _mm_add_ps(weight0, stepW0x4);
+				weight1 = _mm_add_ps(weight1, stepW1x4);
+				weight2 = _mm_add_ps(weight2, stepW2x4);
+				depth = _mm_add_ps(depth, stepZx4);
+			}
+		}
+	}
+
+	Vector4 OcclusionBuffer::ToScreen(const Vector4& clip) const
+	{
+		// Behind the camera only the sign of w matters
+		if (clip.w <= 0.0f) return { 0.0f, 0.0f, 0.0f, -1.0f };
+
+		return {
+			(clip.x / clip.w + 1.0f) * 0.5f * m_Width,
+			(1.0f - clip.y / clip.w) * 0.5f * m_Height,
+			clip.z / clip.w,
+			clip.w
+		};
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+
+#include "DataTypes.h"
+
+namespace dae
+{
+	// Coarse depth-only buffer of the occluders of a frame, objects behind them are skipped before their vertices are transformed
+	// Depths follow the renderer's depth buffer: z / w in [0, 1], smaller is closer, FLT_MAX where no occluder was drawn
+	class OcclusionBuffer final
+	{
+	public:
+		// The width has to be a multiple of 4, rows are rasterized 4 pixels at a time
+		OcclusionBuffer(int width, int height);
+		~OcclusionBuffer() = default;
+
+		OcclusionBuffer(const OcclusionBuffer&) = delete;
+		OcclusionBuffer(OcclusionBuffer&&) noexcept = delete;
+		OcclusionBuffer& operator=(const OcclusionBuffer&) = delete;
+		OcclusionBuffer& operator=(OcclusionBuffer&&) noexcept = delete;
+
+		void Clear();
+
+		// Draws the full detail triangles of the mesh, triangles behind the camera are skipped like the renderer does
+		void RasterizeOccluder(const Mesh& mesh, const Matrix& worldViewProjection);
+
+		// Keeps the farthest depth of every 3x3 neighbourhood, so occluders sampled at pixel centers never cover more than they do
+		// Called once after the last occluder and before the first test
+		void Finalize();
+
+		// True when an occluder is closer than the nearest corner of the box in every pixel the box covers
+		bool IsBoxOccluded(const Vector3& min, const Vector3& max, const Matrix& viewProjection) const;
+
+		int GetWidth() const;
+		int GetHeight() const;
+		float GetDepth(int x, int y) const;
+
+	private:
+		int m_Width{};
+		int m_Height{};
+
+		std::vector<float> m_Depth{};
+
+		// Screen space x, y and depth z of the occluder being drawn, w < 0 behind the camera
+		std::vector<Vector4> m_Positions{};
+		// Result of the horizontal pass of Finalize
+		std::vector<float> m_Filtered{};
+
+		void RasterizeTriangle(const Vector4& v0, const Vector4& v1, const Vector4& v2);
+		Vector4 ToScreen(const Vector4& clip) const;
+	};
+}
@@ -0,0 +1,216 @@
+#include "Quantization.h"
+
+#include <algorithm>
+#include <bit>
+#include <cfloat>
+#include <cmath>
+
+namespace dae
+{
+	namespace Quantization
+	{
+		namespace
+		{
+			uint16_t ToUnorm16(float value)
+			{
+				return static_cast<uint16_t>(std::lround(Saturate(value) * 65535.0f));
+			}
+
+			int16_t ToSnorm16(float value)
+			{
+				return static_cast<int16_t>(std::lround(Clamp(value, -1.0f, 1.0f) * 32767.0f));
+			}
+
+			float FromSnorm16(int16_t value)
+			{
+				return std::max(value / 32767.0f, -1.0f);
+			}
+
+			uint8_t ToUnorm8(float value)
+			{
+				return static_cast<uint8_t>(std::lround(Saturate(value) * 255.0f));
+			}
+
+			float SignNotZero(float value)
+			{
+				return (value >= 0.0f) ? 1.0f : -1.0f;
+			}
+		}
+
+		uint16_t FloatToHalf(float value)
+		{
+			const uint32_t bits = std::bit_cast<uint32_t>(value);
+			const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+			const uint32_t magnitude = bits & 0x7FFFFFFF;
+
+			// NaN stays NaN, overflow and infinity become infinity
+			if (magnitude > 0x7F800000) return sign | 0x7E00;
+			if (magnitude >= 0x477FF000) return sign | 0x7C00;
+
+			// Too small even for a half subnormal
+			if (magnitude < 0x33000000) return sign;
+
+			const int exponent = static_cast<int>(magnitude >> 23) - 127 + 15;
+			uint32_t mantissa = (magnitude & 0x007FFFFF) | 0x00800000;
+
+			if (exponent <= 0)
+			{
+				// Subnormal half, shift the implicit bit into the mantissa and round to nearest even
+				const int shift = 14 - exponent;
+				const uint32_t rounded = (mantissa + (1u << (shift - 1)) - 1 + ((mantissa >> shift) & 1)) >> shift;
+				return sign | static_cast<uint16_t>(rounded);
+			}
+
+			// Normal half, round to nearest even (a carry into the exponent is the correct result)
+			const uint32_t half = (static_cast<uint32_t>(exponent) << 10) | ((mantissa >> 13) & 0x3FF);
+			const uint32_t rounded = half + ((mantissa & 0x1FFF) > 0x1000 || ((mantissa & 0x1FFF) == 0x1000 && (half & 1)));
+			return sign | static_cast<uint16_t>(rounded);
+		}
+
+		float HalfToFloat(uint16_t half)
+		{
+			const uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+			const uint32_t exponent = (half >> 10) & 0x1F;
+			const uint32_t mantissa = half & 0x3FF;
+
+			if (exponent == 0)
+			{
+				// Zero or subnormal: mantissa * 2^-24
+				const float value = std::ldexp(static_cast<float>(mantissa), -24);
+				return (sign != 0) ? -value : value;
+			}
+
+			if (exponent == 31) return std::bit_cast<float>(sign | 0x7F800000 | (mantissa << 13));
+
+			return std::bit_cast<float>(sign | ((exponent - 15 + 127) << 23) | (mantissa << 13));
+		}
+
+		void EncodeOctahedral(const Vector3& direction, int16_t encoded[2])
+		{
+			const float length = std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+
+			// Degenerate directions (zero or NaN) decode to +Z
+			if (!(length > FLT_MIN))
+			{
+				encoded[0] = encoded[1] = 0;
+				return;
+			}
+
+			float x = direction.x / length;
+			float y = direction.y / length;
+
+			// Fold the lower hemisphere over the diagonals
+			if (direction.z < 0.0f)
+			{
+				const float foldedX = (1.0f - std::abs(y)) * SignNotZero(x);
+				const float foldedY = (1.0f - std::abs(x)) * SignNotZero(y);
+				x = foldedX;
+				y = foldedY;
+			}
+
+			encoded[0] = ToSnorm16(x);
+			encoded[1] = ToSnorm16(y);
+		}
+
+		Vector3 DecodeOctahedral(const int16_t encoded[2])
+		{
+			Vector3 direction{ FromSnorm16(encoded[0]), FromSnorm16(encoded[1]), 0.0f };
+			direction.z = 1.0f - std::abs(direction.x) - std::abs(direction.y);
+
+			// Unfold the lower hemisphere
+			const float t = std::max(-direction.z, 0.0f);
+			direction.x += (direction.x >= 0.0f) ? -t : t;
+			direction.y += (direction.y >= 0.0f) ? -t : t;
+
+			return direction.Normalized();
+		}
+
+		QuantizedVertex EncodeVertex(const Vertex& vertex, const QuantizationBox& box)
+		{
+			QuantizedVertex quantized{};
+
+			for (int i = 0; i < 3; ++i)
+			{
+				quantized.position[i] = (box.scale[i] > 0.0f) ? ToUnorm16((vertex.position[i] - box.offset[i]) / (box.scale[i] * 65535.0f)) : 0;
+			}
+
+			quantized.uv[0] = FloatToHalf(vertex.uv.x);
+			quantized.uv[1] = FloatToHalf(vertex.uv.y);
+
+			EncodeOctahedral(vertex.normal, quantized.normal);
+			EncodeOctahedral(vertex.tangent, quantized.tangent);
+
+			quantized.color[0] = ToUnorm8(vertex.color.r);
+			quantized.color[1] = ToUnorm8(vertex.color.g);
+			quantized.color[2] = ToUnorm8(vertex.color.b);
+
+			return quantized;
+		}
+
+		Vertex DecodeVertex(const QuantizedVertex& vertex, const QuantizationBox& box)
+		{
+			Vertex decoded{};
+
+			decoded.position = {
+				box.offset.x + vertex.position[0] * box.scale.x,
+				box.offset.y + vertex.position[1] * box.scale.y,
+				box.offset.z + vertex.position[2] * box.scale.z
+			};
+
+			decoded.uv = { HalfToFloat(vertex.uv[0]), HalfToFloat(vertex.uv[1]) };
+			decoded.normal = DecodeOctahedral(vertex.normal);
+			decoded.tangent = DecodeOctahedral(vertex.tangent);
+			decoded.color = { vertex.color[0] / 255.0f, vertex.color[1] / 255.0f, vertex.color[2] / 255.0f };
+
+			return decoded;
+		}
+
+		bool FitsIndices16(size_t vertexCount, bool primitiveRestart)
+		{
+			return vertexCount <= (primitiveRestart ? UINT16_MAX : UINT16_MAX + 1);
+		}
+
+		void QuantizeMesh(Mesh& mesh)
+		{
+			if (mesh.vertices.empty()) return;
+
+			Vector3 boundsMin{ FLT_MAX, FLT_MAX, FLT_MAX };
+			Vector3 boundsMax{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+			for (const Vertex& vertex : mesh.vertices)
+			{
+				boundsMin = Vector3::Min(boundsMin, vertex.position);
+				boundsMax = Vector3::Max(boundsMax, vertex.position);
+			}
+
+			mesh.quantizationBox.offset = boundsMin;
+			mesh.quantizationBox.scale = (boundsMax - boundsMin) / 65535.0f;
+
+			mesh.quantizedVertices.resize(mesh.vertices.size());
+			std::transform(mesh.vertices.begin(), mesh.vertices.end(), mesh.quantizedVertices.begin(), [&](const Vertex& vertex)
+			{
+				return EncodeVertex(vertex, mesh.quantizationBox);
+			});
+
+			std::vector<Vertex>{}.swap(mesh.vertices);
+
+			if (FitsIndices16(mesh.quantizedVertices.size(), mesh.primitiveRestart))
+			{
+				mesh.indices16.resize(mesh.indices.size());
+				std::transform(mesh.indices.begin(), mesh.indices.end(), mesh.indices16.begin(), [](uint32_t index)
+				{
+					return (index == PRIMITIVE_RESTART_INDEX<uint32_t>) ? PRIMITIVE_RESTART_INDEX<uint16_t> : static_cast<uint16_t>(index);
+				});
+				std::vector<uint32_t>{}.swap(mesh.indices);
+			}
+		}
+
+		size_t GetGeometrySize(const Mesh& mesh)
+		{
+			return mesh.vertices.size() * sizeof(Vertex)
+				+ mesh.quantizedVertices.size() * sizeof(QuantizedVertex)
+				+ mesh.indices.size() * sizeof(uint32_t)
+				+ mesh.indices16.size() * sizeof(uint16_t);
+		}
+	}
+}
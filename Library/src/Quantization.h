@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+
+#include "DataTypes.h"
+
+namespace dae
+{
+	namespace Quantization
+	{
+		uint16_t FloatToHalf(float value);
+		float HalfToFloat(uint16_t half);
+
+		// Octahedral mapping of a unit vector onto two snorm16 values
+		void EncodeOctahedral(const Vector3& direction, int16_t encoded[2]);
+		Vector3 DecodeOctahedral(const int16_t encoded[2]);
+
+		QuantizedVertex EncodeVertex(const Vertex& vertex, const QuantizationBox& box);
+		Vertex DecodeVertex(const QuantizedVertex& vertex, const QuantizationBox& box);
+
+		// Whether every vertex of the mesh is addressable by a 16-bit index, 0xFFFF is reserved when primitive restart is on
+		bool FitsIndices16(size_t vertexCount, bool primitiveRestart);
+
+		// Replaces the vertex stream by quantized vertices and, when FitsIndices16, the index buffer by 16-bit indices
+		// The float streams are released, so the mesh only keeps the compact copy
+		void QuantizeMesh(Mesh& mesh);
+
+		// Bytes used by the vertex and index streams of the mesh, whichever encoding it uses
+		size_t GetGeometrySize(const Mesh& mesh);
+	}
+}
@@ -1,8 +1,17 @@
 #pragma once
+#include <algorithm>
+#include <array>
 #include <cassert>
-#include <fstream>
+#include <charconv>
+#include <cstring>
+#include <execution>
+#include <ranges>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
 #include "Maths.h"
 #include "DataTypes.h"
+#include "MappedFile.h"
 
 //#define DISABLE_OBJ
 
@@ -10,130 +19,265 @@ namespace dae
 {
 	namespace Utils
 	{
-		//Just parses vertices and indices
 #pragma warning(push)
 #pragma warning(disable : 4505) //Warning unreferenced local function
-		static bool ParseOBJ(const std::string& filename, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding = true)
+		// --- OBJ scanner helpers, operating directly on the mapped file contents ---
+		static bool IsBlank(char c)
 		{
-#ifdef DISABLE_OBJ
+			return c == ' ' || c == '\t' || c == '\r';
+		}
 
-			//TODO: Enable the code below after uncommenting all the vertex attributes of DataTypes::Vertex
-			// >> Comment/Remove '#define DISABLE_OBJ'
-			assert(false && "OBJ PARSER not enabled! Check the comments in Utils::ParseOBJ");
+		static void SkipBlanks(const char*& it, const char* end)
+		{
+			while (it != end && IsBlank(*it)) ++it;
+		}
 
-#else
+		static void SkipWhitespace(const char*& it, const char* end)
+		{
+			while (it != end && (IsBlank(*it) || *it == '\n')) ++it;
+		}
 
-			std::ifstream file(filename);
-			if (!file)
-				return false;
+		static void SkipLine(const char*& it, const char* end)
+		{
+			while (it != end && *it != '\n') ++it;
+			if (it != end) ++it;
+		}
+
+		static std::string_view ReadToken(const char*& it, const char* end)
+		{
+			const char* begin = it;
+			while (it != end && !IsBlank(*it) && *it != '\n') ++it;
+			return { begin, static_cast<size_t>(it - begin) };
+		}
+
+		static float ReadFloat(const char*& it, const char* end)
+		{
+			SkipBlanks(it, end);
+			if (it != end && *it == '+') ++it;
 
+			float value{};
+			it = std::from_chars(it, end, value).ptr;
+			return value;
+		}
+
+		static size_t ReadIndex(const char*& it, const char* end)
+		{
+			SkipBlanks(it, end);
+
+			size_t value{};
+			it = std::from_chars(it, end, value).ptr;
+			return value;
+		}
+
+		// --- Chunked parsing ---
+		// A face corner as written in the file: 1-based indices, 0 when the attribute is absent
+		struct OBJFaceCorner
+		{
+			size_t position{};
+			size_t uv{};
+			size_t normal{};
+
+			bool operator==(const OBJFaceCorner&) const = default;
+		};
+
+		struct OBJFaceCornerHash
+		{
+			size_t operator()(const OBJFaceCorner& corner) const
+			{
+				size_t hash = std::hash<size_t>{}(corner.position);
+				hash ^= std::hash<size_t>{}(corner.uv) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+				hash ^= std::hash<size_t>{}(corner.normal) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+				return hash;
+			}
+		};
+
+		// Records of one line-aligned chunk of the file, in file order
+		struct OBJChunk
+		{
 			std::vector<Vector3> positions{};
 			std::vector<Vector3> normals{};
 			std::vector<Vector2> UVs{};
+			std::vector<OBJFaceCorner> corners{};
 
-			vertices.clear();
-			indices.clear();
+			// Filled by the weld: the distinct corners of the chunk in order of first use, the corners as indices into them,
+			// and the vertex every distinct corner became
+			std::vector<OBJFaceCorner> uniqueCorners{};
+			std::vector<uint32_t> cornerIndices{};
+			std::vector<uint32_t> cornerVertices{};
+		};
 
-			std::string sCommand;
-			// start a while iteration ending when the end of file is reached (ios::eof)
-			while (!file.eof())
+		// Chunks smaller than this are not worth a thread of their own
+		constexpr size_t OBJ_MIN_CHUNK_SIZE{ 256 * 1024 };
+
+		// Splits [data, data + size) into chunkCount chunks, cutting only after a '\n'
+		// A chunkCount of 0 takes at most one chunk per hardware thread and none below OBJ_MIN_CHUNK_SIZE
+		static std::vector<std::string_view> SplitOBJChunks(const char* data, size_t size, size_t chunkCount)
+		{
+			if (chunkCount == 0)
 			{
-				//read the first word of the string, use the >> operator (istream::operator>>) 
-				file >> sCommand;
-				//use conditional statements to process the different commands	
-				if (sCommand == "#")
-				{
-					// Ignore Comment
-				}
-				else if (sCommand == "v")
+				const size_t maxChunks = std::max(1u, std::thread::hardware_concurrency());
+				chunkCount = std::clamp(size / OBJ_MIN_CHUNK_SIZE, size_t{ 1 }, maxChunks);
+			}
+
+			const size_t chunkSize = size / chunkCount;
+
+			std::vector<std::string_view> chunks{};
+			chunks.reserve(chunkCount);
+
+			const char* it = data;
+			const char* const end = data + size;
+
+			while (it != end)
+			{
+				const char* chunkEnd = (chunks.size() + 1 == chunkCount) ? end : std::min(end, it + chunkSize);
+				SkipLine(chunkEnd, end);
+
+				chunks.emplace_back(it, static_cast<size_t>(chunkEnd - it));
+				it = chunkEnd;
+			}
+
+			return chunks;
+		}
+
+		static void ParseOBJChunk(std::string_view text, OBJChunk& chunk)
+		{
+			const char* it = text.data();
+			const char* const end = it + text.size();
+
+			// start a while iteration ending when the end of the chunk is reached
+			while (it != end)
+			{
+				//read the first word of the line, blank lines are skipped
+				SkipWhitespace(it, end);
+				const std::string_view command = ReadToken(it, end);
+
+				//use conditional statements to process the different commands
+				if (command == "v")
 				{
 					//Vertex
 					float x, y, z;
-					file >> x >> y >> z;
+					x = ReadFloat(it, end);
+					y = ReadFloat(it, end);
+					z = ReadFloat(it, end);
 
-					positions.emplace_back(x, y, z);
+					chunk.positions.emplace_back(x, y, z);
 				}
-				else if (sCommand == "vt")
+				else if (command == "vt")
 				{
 					// Vertex TexCoord
 					float u, v;
-					file >> u >> v;
-					UVs.emplace_back(u, 1 - v);
+					u = ReadFloat(it, end);
+					v = ReadFloat(it, end);
+					chunk.UVs.emplace_back(u, 1 - v);
 				}
-				else if (sCommand == "vn")
+				else if (command == "vn")
 				{
 					// Vertex Normal
 					float x, y, z;
-					file >> x >> y >> z;
+					x = ReadFloat(it, end);
+					y = ReadFloat(it, end);
+					z = ReadFloat(it, end);
 
-					normals.emplace_back(x, y, z);
+					chunk.normals.emplace_back(x, y, z);
 				}
-				else if (sCommand == "f")
+				else if (command == "f")
 				{
-					//if a face is read:
-					//construct the 3 vertices, add them to the vertex array
-					//add three indices to the index array
-					//add the material index as attibute to the attribute array
-					//
-					// Faces or triangles
-					Vertex vertex{};
-					size_t iPosition, iTexCoord, iNormal;
-
-					uint32_t tempIndices[3];
+					// Faces or triangles, the indices are resolved once all chunks are parsed
+					// Attributes missing on a corner are inherited from the previous corner of the face
+					OBJFaceCorner corner{};
+
 					for (size_t iFace = 0; iFace < 3; iFace++)
 					{
 						// OBJ format uses 1-based arrays
-						file >> iPosition;
-						vertex.position = positions[iPosition - 1];
+						corner.position = ReadIndex(it, end);
 
-						if ('/' == file.peek())//is next in buffer ==  '/' ?
+						if (it != end && '/' == *it)//is next character == '/' ?
 						{
-							file.ignore();//read and ignore one element ('/')
+							++it;//skip one element ('/')
 
-							if ('/' != file.peek())
+							if (it != end && '/' != *it)
 							{
 								// Optional texture coordinate
-								file >> iTexCoord;
-								vertex.uv = UVs[iTexCoord - 1];
+								corner.uv = ReadIndex(it, end);
 							}
 
-							if ('/' == file.peek())
+							if (it != end && '/' == *it)
 							{
-								file.ignore();
+								++it;
 
 								// Optional vertex normal
-								file >> iNormal;
-								vertex.normal = normals[iNormal - 1];
+								corner.normal = ReadIndex(it, end);
 							}
 						}
 
-						vertices.push_back(vertex);
-						tempIndices[iFace] = uint32_t(vertices.size()) - 1;
-						//indices.push_back(uint32_t(vertices.size()) - 1);
+						chunk.corners.push_back(corner);
 					}
+				}
+				//comments and unsupported commands: skip till end of line and ignore all remaining chars
+				SkipLine(it, end);
+			}
+		}
 
-					indices.push_back(tempIndices[0]);
-					if (flipAxisAndWinding) 
-					{
-						indices.push_back(tempIndices[2]);
-						indices.push_back(tempIndices[1]);
-					}
-					else
-					{
-						indices.push_back(tempIndices[1]);
-						indices.push_back(tempIndices[2]);
-					}
+		template<typename T, typename Member>
+		static std::vector<T> MergeOBJChunks(const std::vector<OBJChunk>& chunks, Member member)
+		{
+			size_t count{};
+			for (const OBJChunk& chunk : chunks) count += (chunk.*member).size();
+
+			std::vector<T> merged{};
+			merged.reserve(count);
+			for (const OBJChunk& chunk : chunks) merged.insert(merged.end(), (chunk.*member).begin(), (chunk.*member).end());
+
+			return merged;
+		}
+
+		// Maps every 1-based index of an attribute stream to the first index holding bit-identical data,
+		// so exporters that write one normal per face corner still weld (index 0 stays 0)
+		template<typename T>
+		static std::vector<size_t> CanonicalOBJIndices(const std::vector<T>& values)
+		{
+			using Key = std::array<uint32_t, sizeof(T) / sizeof(uint32_t)>;
+
+			struct KeyHash
+			{
+				size_t operator()(const Key& key) const
+				{
+					size_t hash{};
+					for (uint32_t word : key) hash ^= std::hash<uint32_t>{}(word) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+					return hash;
 				}
-				//read till end of line and ignore all remaining chars
-				file.ignore(1000, '\n');
+			};
+
+			std::unordered_map<Key, size_t, KeyHash> lookup{};
+			lookup.reserve(values.size());
+
+			std::vector<size_t> canonical(values.size() + 1);
+			for (size_t i = 0; i < values.size(); ++i)
+			{
+				Key key;
+				std::memcpy(key.data(), &values[i], sizeof(T));
+
+				canonical[i + 1] = lookup.try_emplace(key, i + 1).first->second;
 			}
 
+			return canonical;
+		}
+
+		// Accumulates per-triangle tangents on their vertices and orthogonalizes them against the normal
+		// Triangles are visited per vertex in index order, so the result does not depend on the thread count
+		static void CalculateTangents(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+		{
+			const size_t triangleCount = indices.size() / 3;
+
 			//Cheap Tangent Calculations
-			for (uint32_t i = 0; i < indices.size(); i += 3)
+			std::vector<Vector3> triangleTangents(triangleCount);
+			const auto triangleRange = std::views::iota(size_t{ 0 }, triangleCount);
+
+			std::for_each(std::execution::par, triangleRange.begin(), triangleRange.end(), [&](size_t triangle)
 			{
-				uint32_t index0 = indices[i];
-				uint32_t index1 = indices[size_t(i) + 1];
-				uint32_t index2 = indices[size_t(i) + 2];
+				uint32_t index0 = indices[triangle * 3];
+				uint32_t index1 = indices[triangle * 3 + 1];
+				uint32_t index2 = indices[triangle * 3 + 2];
 
 				const Vector3& p0 = vertices[index0].position;
 				const Vector3& p1 = vertices[index1].position;
@@ -148,24 +292,161 @@ namespace dae
 				const Vector2 diffY = Vector2(uv1.y - uv0.y, uv2.y - uv0.y);
 				float r = 1.f / Vector2::Cross(diffX, diffY);
 
-				Vector3 tangent = (edge0 * diffY.y - edge1 * diffY.x) * r;
-				vertices[index0].tangent += tangent;
-				vertices[index1].tangent += tangent;
-				vertices[index2].tangent += tangent;
-			}
+				triangleTangents[triangle] = (edge0 * diffY.y - edge1 * diffY.x) * r;
+			});
+
+			// Vertex -> triangle adjacency (compressed rows), built in triangle order
+			std::vector<uint32_t> adjacencyOffsets(vertices.size() + 1);
+			for (uint32_t index : indices) ++adjacencyOffsets[index + 1];
+			for (size_t i = 1; i < adjacencyOffsets.size(); ++i) adjacencyOffsets[i] += adjacencyOffsets[i - 1];
+
+			std::vector<uint32_t> adjacency(indices.size());
+			std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (size_t i = 0; i < indices.size(); ++i) adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
 
 			//Fix the tangents per vertex now because we accumulated
-			for (auto& v : vertices)
+			const auto vertexRange = std::views::iota(size_t{ 0 }, vertices.size());
+
+			std::for_each(std::execution::par, vertexRange.begin(), vertexRange.end(), [&](size_t vertex)
 			{
+				Vertex& v = vertices[vertex];
+
+				for (uint32_t i = adjacencyOffsets[vertex]; i < adjacencyOffsets[vertex + 1]; ++i)
+				{
+					v.tangent += triangleTangents[adjacency[i]];
+				}
+
 				v.tangent = Vector3::Reject(v.tangent, v.normal).Normalized();
+			});
+		}
 
-				if(flipAxisAndWinding)
+		//Just parses vertices and indices
+		//The file is split at line boundaries and the chunks are parsed in parallel, chunkCount as in SplitOBJChunks
+		static bool ParseOBJ(const std::string& filename, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding = true, size_t chunkCount = 0)
+		{
+#ifdef DISABLE_OBJ
+
+			//TODO: Enable the code below after uncommenting all the vertex attributes of DataTypes::Vertex
+			// >> Comment/Remove '#define DISABLE_OBJ'
+			assert(false && "OBJ PARSER not enabled! Check the comments in Utils::ParseOBJ");
+
+#else
+
+			MappedFile file{ filename };
+			if (!file.IsOpen())
+				return false;
+
+			vertices.clear();
+			indices.clear();
+
+			// Parse every chunk into its own buffers
+			const std::vector<std::string_view> text = SplitOBJChunks(file.GetData(), file.GetSize(), chunkCount);
+			std::vector<OBJChunk> chunks(text.size());
+
+			const auto chunkRange = std::views::iota(size_t{ 0 }, chunks.size());
+			std::for_each(std::execution::par, chunkRange.begin(), chunkRange.end(), [&](size_t i)
+			{
+				ParseOBJChunk(text[i], chunks[i]);
+			});
+
+			// OBJ indices are global, so the attribute streams are simply concatenated in file order
+			const std::vector<Vector3> positions = MergeOBJChunks<Vector3>(chunks, &OBJChunk::positions);
+			const std::vector<Vector3> normals = MergeOBJChunks<Vector3>(chunks, &OBJChunk::normals);
+			const std::vector<Vector2> UVs = MergeOBJChunks<Vector2>(chunks, &OBJChunk::UVs);
+
+			// Weld identical (position, uv, normal) triples into a single vertex, in order of first use
+			const std::vector<size_t> canonicalPositions = CanonicalOBJIndices(positions);
+			const std::vector<size_t> canonicalUVs = CanonicalOBJIndices(UVs);
+			const std::vector<size_t> canonicalNormals = CanonicalOBJIndices(normals);
+
+			// Every chunk welds its own corners in parallel
+			std::for_each(std::execution::par, chunkRange.begin(), chunkRange.end(), [&](size_t i)
+			{
+				OBJChunk& chunk = chunks[i];
+
+				std::unordered_map<OBJFaceCorner, uint32_t, OBJFaceCornerHash> chunkLookup{};
+				chunk.cornerIndices.reserve(chunk.corners.size());
+
+				for (const OBJFaceCorner& corner : chunk.corners)
+				{
+					assert(corner.position >= 1 && corner.position <= positions.size() && "OBJ position index out of range");
+					assert(corner.uv <= UVs.size() && "OBJ texcoord index out of range");
+					assert(corner.normal <= normals.size() && "OBJ normal index out of range");
+
+					const OBJFaceCorner key{ canonicalPositions[corner.position], canonicalUVs[corner.uv], canonicalNormals[corner.normal] };
+
+					const auto [it, isNew] = chunkLookup.try_emplace(key, static_cast<uint32_t>(chunk.uniqueCorners.size()));
+					if (isNew) chunk.uniqueCorners.push_back(key);
+
+					chunk.cornerIndices.push_back(it->second);
+				}
+			});
+
+			// Only the distinct corners of the chunks are merged serially, in file order, so vertices keep the order of first use in the file
+			std::unordered_map<OBJFaceCorner, uint32_t, OBJFaceCornerHash> vertexLookup{};
+			std::vector<OBJFaceCorner> uniqueCorners{};
+			std::vector<size_t> indexOffsets(chunks.size() + 1);
+
+			for (size_t i = 0; i < chunks.size(); ++i)
+			{
+				OBJChunk& chunk = chunks[i];
+				chunk.cornerVertices.reserve(chunk.uniqueCorners.size());
+
+				for (const OBJFaceCorner& key : chunk.uniqueCorners)
+				{
+					const auto [it, isNew] = vertexLookup.try_emplace(key, static_cast<uint32_t>(uniqueCorners.size()));
+					if (isNew) uniqueCorners.push_back(key);
+
+					chunk.cornerVertices.push_back(it->second);
+				}
+
+				indexOffsets[i + 1] = indexOffsets[i] + chunk.cornerIndices.size();
+			}
+
+			indices.resize(indexOffsets.back());
+
+			std::for_each(std::execution::par, chunkRange.begin(), chunkRange.end(), [&](size_t i)
+			{
+				const OBJChunk& chunk = chunks[i];
+
+				for (size_t corner = 0; corner < chunk.cornerIndices.size(); ++corner)
+				{
+					indices[indexOffsets[i] + corner] = chunk.cornerVertices[chunk.cornerIndices[corner]];
+				}
+			});
+
+			vertices.resize(uniqueCorners.size());
+
+			const auto vertexRange = std::views::iota(size_t{ 0 }, vertices.size());
+			std::for_each(std::execution::par, vertexRange.begin(), vertexRange.end(), [&](size_t i)
+			{
+				const OBJFaceCorner& corner = uniqueCorners[i];
+				Vertex& vertex = vertices[i];
+
+				vertex.position = positions[corner.position - 1];
+				if (corner.uv != 0) vertex.uv = UVs[corner.uv - 1];
+				if (corner.normal != 0) vertex.normal = normals[corner.normal - 1];
+			});
+
+			// Three corners per face, the winding is flipped by swapping the last two
+			if (flipAxisAndWinding)
+			{
+				for (size_t i = 0; i < indices.size(); i += 3)
+				{
+					std::swap(indices[i + 1], indices[i + 2]);
+				}
+			}
+
+			CalculateTangents(vertices, indices);
+
+			if (flipAxisAndWinding)
+			{
+				std::for_each(std::execution::par, vertices.begin(), vertices.end(), [](Vertex& v)
 				{
 					v.position.z *= -1.f;
 					v.normal.z *= -1.f;
 					v.tangent.z *= -1.f;
-				}
-
+				});
 			}
 
 			return true;
@@ -0,0 +1,1344 @@
+#include "Benchmarks.h"
+
+#include <SDL.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DataTypes.h"
+#include "DepthFormat.h"
+#include "LambertShader.h"
+#include "MappedFile.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "Quantization.h"
+#include "Renderer.h"
+#include "Scene.h"
+#include "Utils.h"
+
+namespace dae
+{
+	namespace Benchmarks
+	{
+		using Clock = std::chrono::high_resolution_clock;
+
+		const char* files[]{ "Resources/vehicle.obj", "Resources/tuktuk.obj" };
+
+		// Windows are created hidden, benchmarks only render into the back buffer
+		SDL_Window* CreateBenchmarkWindow(int width, int height)
+		{
+			return SDL_CreateWindow("Rasterizer - Benchmark", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, width, height, SDL_WINDOW_HIDDEN);
+		}
+
+		// Places the camera like ReferenceScene does, without the input handling of Camera::Update
+		void InitializeBenchmarkCamera(Scene& scene, float aspectRatio, float farPlane = 100.0f, const Vector3& origin = { 0.0f, 5.0f, -64.0f })
+		{
+			Camera& camera = scene.GetCamera();
+			camera.Initialize(aspectRatio, 0.1f, farPlane, 45.0f, origin);
+			camera.CalculateViewMatrix();
+			camera.CalculateProjectionMatrix();
+		}
+
+		// The vehicle loaded the way the renderer draws it fastest, null when the file is missing
+		std::shared_ptr<const Mesh> LoadBenchmarkVehicle()
+		{
+			MeshCache::LoadOptions options{};
+			options.quantize = true;
+			options.stripify = true;
+			options.primitiveRestart = true;
+			options.generateLODs = true;
+
+			Mesh mesh{};
+			if (!MeshCache::LoadOBJ(files[0], mesh, options))
+			{
+				std::cout << files[0] << ": not found" << std::endl;
+				return nullptr;
+			}
+
+			return std::make_shared<const Mesh>(std::move(mesh));
+		}
+
+		// Grid of size x size vehicles 48 units apart, and a camera far enough back to see all of them
+		std::vector<ObjectHandle> CreateVehicleGrid(Scene& scene, const std::shared_ptr<const Mesh>& pVehicle, int size, float aspectRatio)
+		{
+			InitializeBenchmarkCamera(scene, aspectRatio, 1000.0f, { 0.0f, 40.0f, -200.0f });
+
+			std::vector<ObjectHandle> vehicles{};
+			for (int z = 0; z < size; ++z)
+			{
+				for (int x = 0; x < size; ++x)
+				{
+					vehicles.push_back(scene.AddShadableObject({ pVehicle, std::make_shared<LambertShader>() }, Matrix::CreateTranslation((x - size / 2 + 0.5f) * 48.0f, 0.0f, z * 48.0f)));
+				}
+			}
+
+			return vehicles;
+		}
+
+		// Closed box of the given size standing on the origin, as a triangle list with a normal per face
+		Mesh CreateBoxMesh(const Vector3& size)
+		{
+			Mesh mesh{};
+			mesh.primitiveTopology = PrimitiveTopology::TriangleList;
+
+			const Vector3 normals[]{ Vector3::UnitX, -Vector3::UnitX, Vector3::UnitY, -Vector3::UnitY, Vector3::UnitZ, -Vector3::UnitZ };
+			for (const Vector3& normal : normals)
+			{
+				// Two axes spanning the face, ordered so the corners wind the same way on every face
+				const Vector3 tangent = (std::abs(normal.y) > 0.0f) ? Vector3::UnitX : Vector3::UnitY;
+				const Vector3 bitangent = Vector3::Cross(normal, tangent);
+
+				const uint32_t first = static_cast<uint32_t>(mesh.vertices.size());
+				for (int corner = 0; corner < 4; ++corner)
+				{
+					const Vector3 unit = normal + tangent * ((corner & 1) ? 1.0f : -1.0f) + bitangent * ((corner & 2) ? 1.0f : -1.0f);
+
+					Vertex vertex{};
+					vertex.position = { unit.x * size.x * 0.5f, (unit.y + 1.0f) * size.y * 0.5f, unit.z * size.z * 0.5f };
+					vertex.normal = normal;
+					vertex.tangent = tangent;
+					mesh.vertices.push_back(vertex);
+				}
+
+				mesh.indices.insert(mesh.indices.end(), { first, first + 2, first + 1, first + 1, first + 2, first + 3 });
+			}
+
+			mesh.bounds = Bounds::FromVertices(mesh.vertices);
+			return mesh;
+		}
+
+		void RunAll()
+		{
+			ParseOBJ();
+			VertexCache();
+			LoadMesh();
+			QuantizedVertices();
+			MeshCompression();
+			CrowdLOD();
+			Meshlets();
+			FrustumCulling();
+			SceneIndex();
+			OcclusionCulling();
+			SceneGraph();
+			StaticFrames();
+			IncrementalRendering();
+			Viewports();
+			FrameClears();
+			DepthFormats();
+			PixelTiles();
+			PixelPacking();
+		}
+
+		void ParseOBJ()
+		{
+			const int iterations{ 20 };
+			const size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+
+			std::cout << "--- ParseOBJ (" << hardwareThreads << " hardware threads) ---" << std::endl;
+
+			for (const char* path : files)
+			{
+				std::error_code error;
+				const auto fileSize = std::filesystem::file_size(path, error);
+				if (error)
+				{
+					std::cout << path << ": not found" << std::endl;
+					continue;
+				}
+
+				std::vector<Vertex> vertices;
+				std::vector<uint32_t> indices;
+
+				// Warm up the file cache so only parsing is measured
+				Utils::ParseOBJ(path, vertices, indices);
+
+				std::cout << path << ": " << vertices.size() << " vertices, " << indices.size() / 3 << " triangles" << std::endl;
+
+				// One chunk is the serial baseline, 0 is the split ParseOBJ picks by itself
+				std::vector<size_t> chunkCounts{ 1 };
+				for (size_t chunkCount = 2; chunkCount <= std::max(size_t{ 8 }, hardwareThreads); chunkCount *= 2) chunkCounts.push_back(chunkCount);
+				chunkCounts.push_back(0);
+
+				double serialMilliseconds{};
+
+				for (size_t chunkCount : chunkCounts)
+				{
+					const auto start = Clock::now();
+					for (int i = 0; i < iterations; ++i)
+					{
+						Utils::ParseOBJ(path, vertices, indices, true, chunkCount);
+					}
+					const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+					const double milliseconds = elapsed.count() * 1000.0 / iterations;
+					if (chunkCount == 1) serialMilliseconds = milliseconds;
+
+					const double megabytes = static_cast<double>(fileSize) * iterations / (1024.0 * 1024.0);
+
+					std::cout << "  " << (chunkCount == 0 ? std::string{ "default" } : std::to_string(chunkCount)) << " chunks: "
+						<< milliseconds << " ms/parse, "
+						<< megabytes / elapsed.count() << " MB/s, "
+						<< serialMilliseconds / milliseconds << "x" << std::endl;
+				}
+
+				// With fewer cores than chunks the runs above only show the overhead of the split
+				// Timing every chunk on its own gives the critical path on as many cores as chunks, everything but the chunk parse counts as serial
+				MappedFile file{ path };
+				if (!file.IsOpen()) continue;
+
+				const auto parseMilliseconds = [](std::string_view text)
+					{
+						const auto start = Clock::now();
+						for (int i = 0; i < iterations; ++i)
+						{
+							Utils::OBJChunk chunk{};
+							Utils::ParseOBJChunk(text, chunk);
+						}
+						const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+						return elapsed.count() / iterations;
+					};
+
+				const double wholeParseMilliseconds = parseMilliseconds({ file.GetData(), file.GetSize() });
+
+				for (size_t chunkCount = 2; chunkCount <= 8; chunkCount *= 2)
+				{
+					double slowestChunkMilliseconds{};
+					for (std::string_view text : Utils::SplitOBJChunks(file.GetData(), file.GetSize(), chunkCount))
+					{
+						slowestChunkMilliseconds = std::max(slowestChunkMilliseconds, parseMilliseconds(text));
+					}
+
+					const double projectedMilliseconds = serialMilliseconds - wholeParseMilliseconds + slowestChunkMilliseconds;
+					std::cout << "  " << chunkCount << " chunks on " << chunkCount << " cores, projected: "
+						<< projectedMilliseconds << " ms/parse, " << serialMilliseconds / projectedMilliseconds << "x" << std::endl;
+				}
+			}
+		}
+
+		void VertexCache()
+		{
+			std::cout << "--- VertexCache ---" << std::endl;
+
+			for (const char* path : files)
+			{
+				std::vector<Vertex> vertices;
+				std::vector<uint32_t> indices;
+
+				if (!Utils::ParseOBJ(path, vertices, indices))
+				{
+					std::cout << path << ": not found" << std::endl;
+					continue;
+				}
+
+				const float acmrBefore = MeshOptimizer::CalculateACMR(indices, vertices.size());
+
+				const auto start = Clock::now();
+				MeshOptimizer::OptimizeVertexCache(indices, vertices.size());
+				MeshOptimizer::OptimizeVertexFetch(vertices, indices);
+				const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+				const float acmrAfter = MeshOptimizer::CalculateACMR(indices, vertices.size());
+
+				std::cout << path << ": ACMR " << acmrBefore << " -> " << acmrAfter
+					<< " (" << elapsed.count() * 1000.0 << " ms)" << std::endl;
+			}
+		}
+
+		void LoadMesh()
+		{
+			const int iterations{ 20 };
+
+			std::cout << "--- LoadMesh ---" << std::endl;
+
+			for (const char* path : files)
+			{
+				// Makes sure an up to date cache exists
+				Mesh mesh{};
+				if (!MeshCache::LoadOBJ(path, mesh))
+				{
+					std::cout << path << ": not found" << std::endl;
+					continue;
+				}
+
+				const std::string cachePath = MeshCache::GetCachePath(path);
+
+				auto start = Clock::now();
+				for (int i = 0; i < iterations; ++i)
+				{
+					Utils::ParseOBJ(path, mesh.vertices, mesh.indices);
+					MeshOptimizer::OptimizeVertexCache(mesh.indices, mesh.vertices.size());
+					MeshOptimizer::OptimizeVertexFetch(mesh.vertices, mesh.indices);
+				}
+				const std::chrono::duration<double> objElapsed = Clock::now() - start;
+
+				start = Clock::now();
+				for (int i = 0; i < iterations; ++i)
+				{
+					if (!MeshCache::Read(cachePath, path, mesh)) break;
+				}
+				const std::chrono::duration<double> cacheElapsed = Clock::now() - start;
+
+				std::cout << path << ": OBJ " << objElapsed.count() * 1000.0 / iterations << " ms, cache "
+					<< cacheElapsed.count() * 1000.0 / iterations << " ms" << std::endl;
+			}
+		}
+
+		void QuantizedVertices()
+		{
+			const int frames{ 50 };
+
+			std::cout << "--- QuantizedVertices ---" << std::endl;
+
+			Mesh mesh{};
+			if (!MeshCache::LoadOBJ(files[0], mesh))
+			{
+				std::cout << files[0] << ": not found" << std::endl;
+				return;
+			}
+
+			Mesh quantizedMesh = mesh;
+			Quantization::QuantizeMesh(quantizedMesh);
+
+			SDL_Window* pWindow = CreateBenchmarkWindow(640, 480);
+			if (!pWindow) return;
+
+			{
+				Renderer renderer{ pWindow };
+
+				for (const Mesh* pMesh : { &mesh, &quantizedMesh })
+				{
+					Scene scene{};
+					InitializeBenchmarkCamera(scene, renderer.GetAspectRatio());
+					scene.AddShadableObject({ std::make_shared<const Mesh>(*pMesh), std::make_shared<LambertShader>() });
+
+					size_t vertices{};
+					double milliseconds{};
+
+					for (int frame = 0; frame < frames; ++frame)
+					{
+						renderer.Render(&scene);
+						vertices += renderer.GetStatistics().transformedVertices;
+						milliseconds += renderer.GetStatistics().vertexStageMilliseconds;
+					}
+
+					std::cout << files[0] << (pMesh == &mesh ? " float: " : " quantized: ")
+						<< Quantization::GetGeometrySize(*pMesh) / 1024 << " KB geometry, "
+						<< vertices / milliseconds / 1000.0 << " Mvertices/s" << std::endl;
+				}
+			}
+
+			SDL_DestroyWindow(pWindow);
+		}
+
+		void MeshCompression()
+		{
+			const int iterations{ 20 };
+
+			std::cout << "--- MeshCompression ---" << std::endl;
+
+			for (const char* path : files)
+			{
+				Mesh mesh{};
+				if (!MeshCache::LoadOBJ(path, mesh))
+				{
+					std::cout << path << ": not found" << std::endl;
+					continue;
+				}
+
+				Mesh quantizedMesh = mesh;
+				Quantization::QuantizeMesh(quantizedMesh);
+
+				const auto directory = std::filesystem::temp_directory_path();
+				const std::string rawPath = (directory / "benchmark_raw.mesh").string();
+				const std::string compressedPath = (directory / "benchmark_compressed.mesh").string();
+
+				if (!MeshCache::Write(rawPath, path, mesh) || !MeshCache::Write(compressedPath, path, quantizedMesh))
+				{
+					std::cout << path << ": could not write caches" << std::endl;
+					continue;
+				}
+
+				std::cout << path << ": OBJ " << std::filesystem::file_size(path) / 1024 << " KB, raw "
+					<< std::filesystem::file_size(rawPath) / 1024 << " KB, compressed "
+					<< std::filesystem::file_size(compressedPath) / 1024 << " KB";
+
+				for (const std::string& cachePath : { rawPath, compressedPath })
+				{
+					const auto start = Clock::now();
+					for (int i = 0; i < iterations; ++i)
+					{
+						MeshCache::Read(cachePath, path, mesh);
+					}
+					const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+					std::cout << ", " << (cachePath == rawPath ? "raw " : "compressed ") << elapsed.count() * 1000.0 / iterations << " ms";
+				}
+
+				std::cout << std::endl;
+
+				std::filesystem::remove(rawPath);
+				std::filesystem::remove(compressedPath);
+			}
+		}
+
+		void CrowdLOD()
+		{
+			const int frames{ 10 };
+			const int columns{ 10 };
+			const int rows{ 20 };
+
+			std::cout << "--- CrowdLOD (" << columns * rows << " vehicles) ---" << std::endl;
+
+			MeshCache::LoadOptions options{};
+			options.quantize = true;
+			options.stripify = true;
+			options.primitiveRestart = true;
+			options.generateLODs = true;
+
+			Mesh lodMesh{};
+			if (!MeshCache::LoadOBJ(files[0], lodMesh, options))
+			{
+				std::cout << files[0] << ": not found" << std::endl;
+				return;
+			}
+
+			// Same buffers, but only the full detail level to pick from
+			Mesh fullMesh = lodMesh;
+			fullMesh.lods.resize(1);
+
+			SDL_Window* pWindow = CreateBenchmarkWindow(640, 480);
+			if (!pWindow) return;
+
+			{
+				Renderer renderer{ pWindow };
+
+				for (const Mesh* pMesh : { &fullMesh, &lodMesh })
+				{
+					Scene scene{};
+
+					Camera& camera = scene.GetCamera();
+					camera.Initialize(renderer.GetAspectRatio(), 0.1f, 2000.0f, 45.0f, { 0.0f, 10.0f, -100.0f });
+					camera.CalculateViewMatrix();
+					camera.CalculateProjectionMatrix();
+
+					// Every vehicle is an instance of the same geometry
+					const auto pSharedMesh = std::make_shared<const Mesh>(*pMesh);
+					const auto pShader = std::make_shared<LambertShader>();
+
+					// Rows recede from the camera, so the crowd covers every distance band
+					for (int row = 0; row < rows; ++row)
+					{
+						for (int column = 0; column < columns; ++column)
+						{
+							scene.AddShadableObject({ pSharedMesh, pShader }, Matrix::CreateTranslation((column - (columns - 1) * 0.5f) * 40.0f, 0.0f, row * 60.0f));
+						}
+					}
+
+					size_t vertices{};
+					double milliseconds{};
+
+					for (int frame = 0; frame < frames; ++frame)
+					{
+						const auto start = Clock::now();
+						renderer.Render(&scene);
+						const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+
+						vertices += renderer.GetStatistics().transformedVertices;
+						milliseconds += elapsed.count();
+					}
+
+					std::vector<size_t> histogram(pMesh->lods.size());
+					for (const ShadableObject& object : scene.GetShadableObjects()) ++histogram[object.lod];
+
+					std::cout << files[0] << (pMesh == &fullMesh ? " full detail: " : " LOD: ")
+						<< milliseconds / frames << " ms/frame, "
+						<< vertices / frames << " vertices/frame, objects per level";
+
+					for (size_t count : histogram) std::cout << " " << count;
+
+					std::cout << std::endl;
+				}
+
+				std::cout << files[0] << ": " << columns * rows << " objects share " << Quantization::GetGeometrySize(lodMesh) / 1024
+					<< " KB of geometry, " << sizeof(ShadableObject) + sizeof(Matrix) + sizeof(Bounds) << " bytes per object" << std::endl;
+			}
+
+			SDL_DestroyWindow(pWindow);
+		}
+
+		void Meshlets()
+		{
+			const int views{ 16 };
+
+			std::cout << "--- Meshlets ---" << std::endl;
+
+			MeshCache::LoadOptions options{};
+			options.quantize = true;
+			options.stripify = true;
+			options.primitiveRestart = true;
+
+			// Every load with other options rebuilds the cache, so the meshlet mesh is built last like ReferenceScene uses it
+			Mesh mesh{};
+			Mesh meshletMesh{};
+			if (!MeshCache::LoadOBJ(files[0], mesh, options))
+			{
+				std::cout << files[0] << ": not found" << std::endl;
+				return;
+			}
+
+			options.buildMeshlets = true;
+			MeshCache::LoadOBJ(files[0], meshletMesh, options);
+
+			SDL_Window* pWindow = CreateBenchmarkWindow(640, 480);
+			if (!pWindow) return;
+
+			{
+				Renderer renderer{ pWindow };
+
+				for (const Mesh* pMesh : { &mesh, &meshletMesh })
+				{
+					Scene scene{};
+					InitializeBenchmarkCamera(scene, renderer.GetAspectRatio());
+					const ObjectHandle object = scene.AddShadableObject({ std::make_shared<const Mesh>(*pMesh), std::make_shared<LambertShader>() });
+
+					size_t vertices{};
+					size_t culledMeshlets{};
+					double vertexMilliseconds{};
+					double frameMilliseconds{};
+
+					// The vehicle turns a full circle, so every side faces the camera once
+					for (int view = 0; view < views; ++view)
+					{
+						scene.SetLocalMatrix(object, Matrix::CreateRotationY(view * 2.0f * PI / views));
+
+						const auto start = Clock::now();
+						renderer.Render(&scene);
+						const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+
+						vertices += renderer.GetStatistics().transformedVertices;
+						culledMeshlets += renderer.GetStatistics().culledMeshlets;
+						vertexMilliseconds += renderer.GetStatistics().vertexStageMilliseconds;
+						frameMilliseconds += elapsed.count();
+					}
+
+					std::cout << files[0] << (pMesh == &mesh ? " whole mesh: " : " meshlets: ")
+						<< vertices / views << " vertices/frame, "
+						<< culledMeshlets / views << " of " << pMesh->meshlets.size() << " meshlets culled/frame, vertex stage "
+						<< vertexMilliseconds / views << " ms, frame " << frameMilliseconds / views << " ms" << std::endl;
+				}
+			}
+
+			SDL_DestroyWindow(pWindow);
+		}
+
+		void FrustumCulling()
+		{
+			const int frames{ 10 };
+			const int count{ 64 };
+
+			std::cout << "--- FrustumCulling (" << count << " vehicles) ---" << std::endl;
+
+			MeshCache::LoadOptions options{};
+			options.quantize = true;
+			options.stripify = true;
+			options.primitiveRestart = true;
+			options.generateLODs = true;
+
+			Mesh mesh{};
+			if (!MeshCache::LoadOBJ(files[0], mesh, options))
+			{
+				std::cout << files[0] << ": not found" << std::endl;
+				return;
+			}
+
+			const auto pMesh = std::make_shared<const Mesh>(std::move(mesh));
+
+			SDL_Window* pWindow = CreateBenchmarkWindow(640, 480);
+			if (!pWindow) return;
+
+			{
+				Renderer renderer{ pWindow };
+
+				Scene scene{};
+
+				Camera& camera = scene.GetCamera();
+				camera.Initialize(renderer.GetAspectRatio(), 0.1f, 1000.0f, 45.0f, { 0.0f, 10.0f, 0.0f });
+				camera.CalculateViewMatrix();
+				camera.CalculateProjectionMatrix();
+
+				// Most of the ring is beside or behind the camera
+				for (int i = 0; i < count; ++i)
+				{
+					const float angle = i * 2.0f * PI / count;
+
+					scene.AddShadableObject({ pMesh, std::make_shared<LambertShader>() }, Matrix::CreateRotationY(angle) * Matrix::CreateTranslation(std::sin(angle) * 150.0f, 0.0f, std::cos(angle) * 150.0f));
+				}
+
+				double milliseconds{};
+
+				for (int frame = 0; frame < frames; ++frame)
+				{
+					const auto start = Clock::now();
+					renderer.Render(&scene);
+					const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+
+					milliseconds += elapsed.count();
+				}
+
+				const RenderStatistics& statistics = renderer.GetStatistics();
+
+				std::cout << files[0] << ": " << statistics.drawnObjects << " drawn, " << statistics.culledObjects << " culled, "
+					<< statistics.transformedVertices << " vertices/frame, " << milliseconds / frames << " ms/frame" << std::endl;
+			}
+
+			SDL_DestroyWindow(pWindow);
+		}
+
+		void SceneIndex()
+		{
+			const int iterations{ 20 };
+			const int size{ 250 };
+			const int movedPerFrame{ 500 };
+
+			std::cout << "--- SceneIndex (" << size * size << " props) ---" << std::endl;
+
+			// Props only need bounds, culling never looks at their buffers
+			Mesh prop{};
+			std::vector<Vertex> corners(2);
+			corners[0].position = { -1.0f, 0.0f, -1.0f };
+			corners[1].position = { 1.0f, 4.0f, 1.0f };
+			prop.bounds = Bounds::FromVertices(corners);
+			const auto pProp = std::make_shared<const Mesh>(prop);
+
+			Scene scene{};
+
+			Camera& camera = scene.GetCamera();
+			camera.Initialize(640.0f / 480.0f, 0.1f, 300.0f, 45.0f, { 0.0f, 10.0f, 0.0f });
+			camera.CalculateViewMatrix();
+			camera.CalculateProjectionMatrix();
+
+			std::vector<ObjectHandle> props{};
+			for (int z = 0; z < size; ++z)
+			{
+				for (int x = 0; x < size; ++x)
+				{
+					props.push_back(scene.AddShadableObject({ pProp, nullptr }, Matrix::CreateTranslation((x - size / 2) * 8.0f, 0.0f, (z - size / 2) * 8.0f)));
+				}
+			}
+
+			const Frustum frustum = Frustum::FromMatrix(camera.viewMatrix * camera.projectionMatrix);
+
+			auto start = Clock::now();
+			scene.UpdateSpatialIndex();
+			const std::chrono::duration<double, std::milli> buildElapsed = Clock::now() - start;
+
+			std::vector<uint32_t> visible{};
+
+			start = Clock::now();
+			for (int i = 0; i < iterations; ++i)
+			{
+				visible.clear();
+				const std::span<const Bounds> worldBounds = scene.GetWorldBounds();
+				for (uint32_t object = 0; object < worldBounds.size(); ++object)
+				{
+					if (!frustum.IsBoxOutside(worldBounds[object].min, worldBounds[object].max)) visible.push_back(object);
+				}
+			}
+			const std::chrono::duration<double, std::milli> linearElapsed = Clock::now() - start;
+
+			start = Clock::now();
+			for (int i = 0; i < iterations; ++i)
+			{
+				visible.clear();
+				scene.QueryFrustum(frustum, visible);
+			}
+			const std::chrono::duration<double, std::milli> queryElapsed = Clock::now() - start;
+
+			// Some props move a little every frame
+			start = Clock::now();
+			for (int i = 0; i < iterations; ++i)
+			{
+				for (int moved = 0; moved < movedPerFrame; ++moved)
+				{
+					const ObjectHandle prop = props[(i * movedPerFrame + moved) * 7919 % props.size()];
+					scene.SetLocalMatrix(prop, Matrix::CreateTranslation(0.5f, 0.0f, 0.0f) * scene.GetLocalMatrix(prop));
+				}
+				scene.UpdateTransforms();
+				scene.UpdateSpatialIndex();
+			}
+			const std::chrono::duration<double, std::milli> refitElapsed = Clock::now() - start;
+
+			std::cout << visible.size() << " visible, build " << buildElapsed.count() << " ms, cull every object "
+				<< linearElapsed.count() / iterations << " ms, BVH query " << queryElapsed.count() / iterations << " ms, refit "
+				<< movedPerFrame << " moved props " << refitElapsed.count() / iterations << " ms" << std::endl;
+		}
+
+		void OcclusionCulling()
+		{
+			const int frames{ 10 };
+			const int rows{ 8 };
+			const int columns{ 12 };
+
+			std::cout << "--- OcclusionCulling (" << rows * columns << " vehicles) ---" << std::endl;
+
+			MeshCache::LoadOptions options{};
+			options.quantize = true;
+			options.stripify = true;
+			options.primitiveRestart = true;
+			options.generateLODs = true;
+
+			Mesh mesh{};
+			if (!MeshCache::LoadOBJ(files[0], mesh, options))
+			{
+				std::cout << files[0] << ": not found" << std::endl;
+				return;
+			}
+
+			const auto pMesh = std::make_shared<const Mesh>(std::move(mesh));
+			const auto pBuilding = std::make_shared<const Mesh>(CreateBoxMesh({ 76.0f, 60.0f, 4.0f }));
+
+			SDL_Window* pWindow = CreateBenchmarkWindow(640, 480);
+			if (!pWindow) return;
+
+			{
+				Renderer renderer{ pWindow };
+
+				Scene scene{};
+
+				Camera& camera = scene.GetCamera();
+				camera.Initialize(renderer.GetAspectRatio(), 0.1f, 1000.0f, 45.0f, { 0.0f, 10.0f, 0.0f });
+				camera.CalculateViewMatrix();
+				camera.CalculateProjectionMatrix();
+
+				// A row of buildings with narrow gaps between them, most of the street behind it is hidden
+				for (int i = -3; i <= 3; ++i)
+				{
+					ShadableObject building{ pBuilding, std::make_shared<LambertShader>() };
+					building.isOccluder = true;
+					scene.AddShadableObject(building, Matrix::CreateTranslation(i * 80.0f, 0.0f, 100.0f));
+				}
+
+				std::vector<ObjectHandle> vehicles{};
+				for (int row = 0; row < rows; ++row)
+				{
+					for (int column = 0; column < columns; ++column)
+					{
+						vehicles.push_back(scene.AddShadableObject({ pMesh, std::make_shared<LambertShader>() },
+							Matrix::CreateTranslation((column - columns / 2) * 48.0f, -pMesh->bounds.min.y, 150.0f + row * 40.0f)));
+					}
+				}
+
+				for (bool isOcclusionCulled : { true, false })
+				{
+					double milliseconds{};
+
+					for (int frame = 0; frame < frames; ++frame)
+					{
+						const auto start = Clock::now();
+						renderer.Render(&scene);
+						const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+
+						milliseconds += elapsed.count();
+					}
+
+					const RenderStatistics& statistics = renderer.GetStatistics();
+
+					std::cout << files[0] << (isOcclusionCulled ? " occlusion culled: " : " frustum culled: ")
+						<< statistics.drawnObjects << " drawn, " << statistics.occludedObjects << " occluded, "
+						<< statistics.occlusionTests << " boxes tested, " << statistics.transformedVertices << " vertices/frame, " << milliseconds / frames << " ms/frame" << std::endl;
+
+					renderer.ToggleOcclusionCulling();
+				}
+
+				// Occlusion queries tell the same from the finished depth buffer, whatever was culled
+				std::vector<OcclusionQuery> queries{};
+				for (ObjectHandle vehicle : vehicles)
+				{
+					queries.push_back(renderer.IssueOcclusionQuery(scene.GetWorldBounds(vehicle)));
+				}
+
+				renderer.Render(&scene);
+
+				int hiddenCount{};
+				for (const OcclusionQuery& query : queries)
+				{
+					size_t visibleSamples{};
+					if (renderer.GetOcclusionQueryResult(query, visibleSamples) && visibleSamples == 0) ++hiddenCount;
+				}
+
+				const auto start = Clock::now();
+				size_t totalSamples{};
+				for (ObjectHandle vehicle : vehicles)
+				{
+					totalSamples += renderer.CountVisibleSamples(scene.GetWorldBounds(vehicle));
+				}
+				const std::chrono::duration<double, std::milli> queryElapsed = Clock::now() - start;
+
+				std::cout << files[0] << " occlusion queries: " << hiddenCount << " hidden, " << totalSamples << " visible samples, "
+					<< queryElapsed.count() << " ms for " << vehicles.size() << " queries" << std::endl;
+			}
+
+			SDL_DestroyWindow(pWindow);
+		}
+
+		void SceneGraph()
+		{
+			const int iterations{ 20 };
+			const int groups{ 250 };
+			const int propsPerGroup{ 250 };
+			const int movedPerFrame{ 5 };
+
+			std::cout << "--- SceneGraph (" << groups << " groups of " << propsPerGroup << " props) ---" << std::endl;
+
+			Mesh prop{};
+			std::vector<Vertex> corners(2);
+			corners[0].position = { -1.0f, 0.0f, -1.0f };
+			corners[1].position = { 1.0f, 4.0f, 1.0f };
+			prop.bounds = Bounds::FromVertices(corners);
+			const auto pProp = std::make_shared<const Mesh>(prop);
+
+			// Every group is a bare transform carrying a row of props
+			Scene scene{};
+			std::vector<ObjectHandle> roots{};
+			for (int group = 0; group < groups; ++group)
+			{
+				const ObjectHandle root = scene.AddShadableObject({}, Matrix::CreateTranslation(0.0f, 0.0f, group * 8.0f));
+				for (int index = 0; index < propsPerGroup; ++index)
+				{
+					scene.AddShadableObject({ pProp, nullptr }, Matrix::CreateTranslation(index * 8.0f, 0.0f, 0.0f), root);
+				}
+				roots.push_back(root);
+			}
+			scene.UpdateTransforms();
+			scene.UpdateSpatialIndex();
+
+			auto start = Clock::now();
+			for (int i = 0; i < iterations; ++i)
+			{
+				scene.UpdateTransforms();
+				scene.UpdateSpatialIndex();
+			}
+			const std::chrono::duration<double, std::milli> staticElapsed = Clock::now() - start;
+
+			start = Clock::now();
+			for (int i = 0; i < iterations; ++i)
+			{
+				for (int moved = 0; moved < movedPerFrame; ++moved)
+				{
+					const ObjectHandle root = roots[(i * movedPerFrame + moved) * 31 % roots.size()];
+					scene.SetLocalMatrix(root, Matrix::CreateTranslation(0.0f, 0.5f, 0.0f) * scene.GetLocalMatrix(root));
+				}
+				scene.UpdateTransforms();
+				scene.UpdateSpatialIndex();
+			}
+			const std::chrono::duration<double, std::milli> movedElapsed = Clock::now() - start;
+
+			start = Clock::now();
+			for (int i = 0; i < iterations; ++i)
+			{
+				for (ObjectHandle root : roots)
+				{
+					scene.SetLocalMatrix(root, Matrix::CreateTranslation(0.0f, 0.5f, 0.0f) * scene.GetLocalMatrix(root));
+				}
+				scene.UpdateTransforms();
+				scene.UpdateSpatialIndex();
+			}
+			const std::chrono::duration<double, std::milli> allElapsed = Clock::now() - start;
+
+			std::cout << "static " << staticElapsed.count() / iterations << " ms, " << movedPerFrame << " moved groups "
+				<< movedElapsed.count() / iterations << " ms, every group moved " << allElapsed.count() / iterations << " ms" << std::endl;
+		}
+
+		void StaticFrames()
+		{
+			const int frames{ 10 };
+			const int size{ 4 };
+
+			std::cout << "--- StaticFrames (" << size * size << " vehicles) ---" << std::endl;
+
+			const std::shared_ptr<const Mesh> pMesh = LoadBenchmarkVehicle();
+			if (!pMesh) return;
+
+			SDL_Window* pWindow = CreateBenchmarkWindow(640, 480);
+			if (!pWindow) return;
+
+			{
+				Renderer renderer{ pWindow };
+
+				Scene scene{};
+
+				const std::vector<ObjectHandle> vehicles = CreateVehicleGrid(scene, pMesh, size, renderer.GetAspectRatio());
+				Camera& camera = scene.GetCamera();
+
+				// Nothing moves, then only the camera, then only one vehicle
+				const char* cases[]{ "static", "camera moved", "one vehicle moved" };
+				for (int test = 0; test < 3; ++test)
+				{
+					renderer.Render(&scene);
+
+					double vertexMilliseconds{};
+					size_t transformedVertices{};
+					size_t skippedVertices{};
+
+					for (int frame = 0; frame < frames; ++frame)
+					{
+						if (test == 1)
+						{
+							camera.origin.x += 0.1f;
+							camera.CalculateViewMatrix();
+						}
+						else if (test == 2)
+						{
+							const ObjectHandle vehicle = vehicles[vehicles.size() / 2];
+							scene.SetLocalMatrix(vehicle, Matrix::CreateRotationY(0.1f) * scene.GetLocalMatrix(vehicle));
+						}
+
+						renderer.Render(&scene);
+
+						vertexMilliseconds += renderer.GetStatistics().vertexStageMilliseconds;
+						transformedVertices += renderer.GetStatistics().transformedVertices;
+						skippedVertices += renderer.GetStatistics().skippedVertices;
+					}
+
+					std::cout << cases[test] << ": " << renderer.GetStatistics().drawnObjects << " drawn, " << transformedVertices / frames << " transformed, " << skippedVertices / frames
+						<< " skipped vertices/frame, vertex stage " << vertexMilliseconds / frames << " ms/frame" << std::endl;
+				}
+			}
+
+			SDL_DestroyWindow(pWindow);
+		}
+
+		void IncrementalRendering()
+		{
+			const int frames{ 10 };
+			const int size{ 4 };
+
+			std::cout << "--- IncrementalRendering (" << size * size << " vehicles) ---" << std::endl;
+
+			const std::shared_ptr<const Mesh> pMesh = LoadBenchmarkVehicle();
+			if (!pMesh) return;
+
+			SDL_Window* pWindow = CreateBenchmarkWindow(640, 480);
+			if (!pWindow) return;
+
+			{
+				Renderer renderer{ pWindow };
+
+				Scene scene{};
+
+				const std::vector<ObjectHandle> vehicles = CreateVehicleGrid(scene, pMesh, size, renderer.GetAspectRatio());
+
+				for (bool isIncremental : { false, true })
+				{
+					// Nothing moves, then one vehicle turns
+					for (bool isTurning : { false, true })
+					{
+						renderer.Render(&scene);
+
+						double milliseconds{};
+						size_t redrawnPixels{};
+
+						for (int frame = 0; frame < frames; ++frame)
+						{
+							if (isTurning)
+							{
+								const ObjectHandle vehicle = vehicles[vehicles.size() / 2];
+								scene.SetLocalMatrix(vehicle, Matrix::CreateRotationY(0.1f) * scene.GetLocalMatrix(vehicle));
+							}
+
+							const auto start = Clock::now();
+							renderer.Render(&scene);
+							const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+
+							milliseconds += elapsed.count();
+							redrawnPixels += renderer.GetStatistics().redrawnPixels;
+						}
+
+						std::cout << (isIncremental ? "incremental, " : "full frames, ") << (isTurning ? "one vehicle turning: " : "static: ")
+							<< milliseconds / frames << " ms/frame, " << redrawnPixels / frames << " redrawn pixels/frame" << std::endl;
+					}
+
+					renderer.ToggleIncrementalRendering();
+				}
+			}
+
+			SDL_DestroyWindow(pWindow);
+		}
+
+		void Viewports()
+		{
+			const int frames{ 10 };
+			const int size{ 4 };
+			const int width{ 640 };
+			const int height{ 480 };
+			const int tiles{ 4 };
+
+			std::cout << "--- Viewports (" << size * size << " vehicles) ---" << std::endl;
+
+			const std::shared_ptr<const Mesh> pMesh = LoadBenchmarkVehicle();
+			if (!pMesh) return;
+
+			SDL_Window* pWindow = CreateBenchmarkWindow(width, height);
+			if (!pWindow) return;
+
+			{
+				Renderer renderer{ pWindow };
+
+				Scene scene{};
+
+				CreateVehicleGrid(scene, pMesh, size, renderer.GetAspectRatio());
+				Camera& camera = scene.GetCamera();
+
+				const ScreenRect screen{ 0, 0, width, height };
+
+				const auto timeFrames = [&](const std::function<void()>& render)
+				{
+					render();
+
+					const auto start = Clock::now();
+					for (int frame = 0; frame < frames; ++frame)
+					{
+						render();
+					}
+					const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+
+					return elapsed.count() / frames;
+				};
+
+				const double fullMilliseconds = timeFrames([&] { renderer.Render(&scene); });
+
+				// Tiles of the same frame, each only clearing and rasterizing its own pixels
+				const double tileMilliseconds = timeFrames([&]
+				{
+					for (int y = 0; y < tiles; ++y)
+					{
+						for (int x = 0; x < tiles; ++x)
+						{
+							renderer.Render(&scene, screen, { x * width / tiles, y * height / tiles, (x + 1) * width / tiles, (y + 1) * height / tiles });
+						}
+					}
+				});
+
+				// Both halves of the window show the scene from a camera of their own aspect ratio
+				camera.aspectRatio = 0.5f * width / height;
+				camera.CalculateProjectionMatrix();
+
+				const double splitMilliseconds = timeFrames([&]
+				{
+					const ScreenRect left{ 0, 0, width / 2, height };
+					const ScreenRect right{ width / 2, 0, width, height };
+					renderer.Render(&scene, left, left);
+					renderer.Render(&scene, right, right);
+				});
+
+				std::cout << "full frame " << fullMilliseconds << " ms, " << tiles * tiles << " scissor tiles " << tileMilliseconds
+					<< " ms, split screen " << splitMilliseconds << " ms" << std::endl;
+			}
+
+			SDL_DestroyWindow(pWindow);
+		}
+
+		void FrameClears()
+		{
+			const int frames{ 10 };
+			const int resolutions[][2]{ { 1920, 1080 }, { 3840, 2160 } };
+
+			std::cout << "--- FrameClears ---" << std::endl;
+
+			MeshCache::LoadOptions options{};
+			options.quantize = true;
+			options.stripify = true;
+			options.primitiveRestart = true;
+			options.generateLODs = true;
+
+			Mesh mesh{};
+			if (!MeshCache::LoadOBJ(files[0], mesh, options))
+			{
+				std::cout << files[0] << ": not found" << std::endl;
+				return;
+			}
+
+			const auto pMesh = std::make_shared<const Mesh>(std::move(mesh));
+
+			for (const auto& resolution : resolutions)
+			{
+				SDL_Window* pWindow = CreateBenchmarkWindow(resolution[0], resolution[1]);
+				if (!pWindow) return;
+
+				{
+					Renderer renderer{ pWindow };
+
+					// Most of the screen stays empty, as in a viewport showing a single object
+					Scene scene{};
+					InitializeBenchmarkCamera(scene, renderer.GetAspectRatio());
+
+					Scene emptyScene{};
+					InitializeBenchmarkCamera(emptyScene, renderer.GetAspectRatio());
+
+					scene.AddShadableObject({ pMesh, std::make_shared<LambertShader>() }, Matrix::CreateTranslation(0.0f, 0.0f, 60.0f));
+
+					for (Scene* pScene : { &emptyScene, &scene })
+					{
+						renderer.Render(pScene);
+
+						const auto start = Clock::now();
+						for (int frame = 0; frame < frames; ++frame)
+						{
+							renderer.Render(pScene);
+						}
+						const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+
+						std::cout << resolution[0] << "x" << resolution[1] << (pScene == &scene ? " one vehicle: " : " empty: ")
+							<< elapsed.count() / frames << " ms/frame" << std::endl;
+					}
+				}
+
+				SDL_DestroyWindow(pWindow);
+			}
+		}
+	
+		// View space distance between two changes of the stored depth value, just beyond the given distance
+		template<typename Depth>
+		float GetDepthResolution(const Matrix& projection, float distance)
+		{
+			// z / w in double, so only the rounding of the stored value shows
+			const auto encode = [&projection](double z)
+				{
+					return Depth::Encode(static_cast<float>((projection[2].z * z + projection[3].z) / z));
+				};
+
+			const auto findStep = [&encode](double start)
+				{
+					const typename Depth::Value value = encode(start);
+
+					double step{ start * 1e-9 };
+					while (encode(start + step) == value && step < start) step *= 1.01f;
+
+					return step;
+				};
+
+			// Measured between two value changes, the first one lies anywhere inside the step of the start distance
+			const double boundary = distance + findStep(distance);
+			return static_cast<float>(findStep(boundary));
+		}
+
+		void DepthFormats()
+		{
+			const int frames{ 5 };
+			const float nearPlane{ 0.1f };
+			const float farPlane{ 1000.0f };
+
+			std::cout << "--- DepthFormats ---" << std::endl;
+
+			MeshCache::LoadOptions options{};
+			options.quantize = true;
+			options.stripify = true;
+			options.primitiveRestart = true;
+			options.generateLODs = true;
+
+			Mesh mesh{};
+			if (!MeshCache::LoadOBJ(files[0], mesh, options))
+			{
+				std::cout << files[0] << ": not found" << std::endl;
+				return;
+			}
+
+			const auto pMesh = std::make_shared<const Mesh>(std::move(mesh));
+
+			SDL_Window* pWindow = CreateBenchmarkWindow(1920, 1080);
+			if (!pWindow) return;
+
+			{
+				Renderer renderer{ pWindow };
+
+				// Rows of vehicles reaching far away, with a far plane where precision runs out
+				Scene scene{};
+				Camera& camera = scene.GetCamera();
+				camera.Initialize(renderer.GetAspectRatio(), nearPlane, farPlane, 45.0f, { 0.0f, 5.0f, -64.0f });
+				camera.CalculateViewMatrix();
+				camera.CalculateProjectionMatrix();
+
+				for (int row = 0; row < 10; ++row)
+				{
+					for (int column = -2; column <= 2; ++column)
+					{
+						scene.AddShadableObject({ pMesh, std::make_shared<LambertShader>() }, Matrix::CreateTranslation(column * 30.0f, 0.0f, row * 80.0f));
+					}
+				}
+
+				const Matrix projection = Matrix::CreatePerspectiveFovLH(camera.fov, camera.aspectRatio, nearPlane, farPlane);
+				const Matrix reversedProjection = Matrix::CreatePerspectiveFovLHReversedZ(camera.fov, camera.aspectRatio, nearPlane, farPlane);
+
+				const std::pair<DepthFormat, const char*> formats[]{
+					{ DepthFormat::Float32, "Float32" },
+					{ DepthFormat::ReversedFloat32, "ReversedFloat32" },
+					{ DepthFormat::Unorm16, "Unorm16" },
+					{ DepthFormat::Unorm24Stencil8, "Unorm24Stencil8" }
+				};
+
+				for (const auto& [format, name] : formats)
+				{
+					renderer.SetDepthFormat(format);
+					renderer.Render(&scene);
+
+					const auto start = Clock::now();
+					for (int frame = 0; frame < frames; ++frame)
+					{
+						renderer.Invalidate();
+						renderer.Render(&scene);
+					}
+					const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+
+					std::cout << name << ": " << elapsed.count() / frames << " ms/frame, depth buffer "
+						<< 1920.0 * 1080.0 * GetDepthSize(format) / (1024 * 1024) << " MB, resolution at";
+
+					for (float distance : { 10.0f, 100.0f, 500.0f })
+					{
+						float resolution{};
+						switch (format)
+						{
+							case DepthFormat::Float32:
+								resolution = GetDepthResolution<DepthEncoding::Float32>(projection, distance);
+								break;
+
+							case DepthFormat::ReversedFloat32:
+								resolution = GetDepthResolution<DepthEncoding::ReversedFloat32>(reversedProjection, distance);
+								break;
+
+							case DepthFormat::Unorm16:
+								resolution = GetDepthResolution<DepthEncoding::Unorm16>(projection, distance);
+								break;
+
+							case DepthFormat::Unorm24Stencil8:
+								resolution = GetDepthResolution<DepthEncoding::Unorm24Stencil8>(projection, distance);
+								break;
+						}
+
+						std::cout << " " << distance << ": " << resolution;
+					}
+
+					std::cout << std::endl;
+				}
+			}
+
+			SDL_DestroyWindow(pWindow);
+		}
+	
+		void PixelTiles()
+		{
+			const int frames{ 10 };
+
+			std::cout << "--- PixelTiles ---" << std::endl;
+
+			MeshCache::LoadOptions options{};
+			options.quantize = true;
+			options.stripify = true;
+			options.primitiveRestart = true;
+			options.generateLODs = true;
+
+			Mesh mesh{};
+			if (!MeshCache::LoadOBJ(files[0], mesh, options))
+			{
+				std::cout << files[0] << ": not found" << std::endl;
+				return;
+			}
+
+			const auto pMesh = std::make_shared<const Mesh>(std::move(mesh));
+
+			SDL_Window* pWindow = CreateBenchmarkWindow(1920, 1080);
+			if (!pWindow) return;
+
+			{
+				Renderer renderer{ pWindow };
+
+				// One vehicle filling the screen, where triangles are large, and a grid of small ones
+				Scene closeScene{};
+				InitializeBenchmarkCamera(closeScene, renderer.GetAspectRatio());
+				closeScene.AddShadableObject({ pMesh, std::make_shared<LambertShader>() }, Matrix::CreateTranslation(0.0f, 0.0f, -30.0f));
+
+				Scene gridScene{};
+				InitializeBenchmarkCamera(gridScene, renderer.GetAspectRatio());
+				for (int row = 0; row < 4; ++row)
+				{
+					for (int column = -3; column <= 3; ++column)
+					{
+						gridScene.AddShadableObject({ pMesh, std::make_shared<LambertShader>() }, Matrix::CreateTranslation(column * 30.0f, 0.0f, row * 30.0f));
+					}
+				}
+
+				for (Scene* pScene : { &closeScene, &gridScene })
+				{
+					renderer.Render(pScene);
+
+					double resolveMilliseconds{};
+
+					const auto start = Clock::now();
+					for (int frame = 0; frame < frames; ++frame)
+					{
+						renderer.Invalidate();
+						renderer.Render(pScene);
+						resolveMilliseconds += renderer.GetStatistics().resolveMilliseconds;
+					}
+					const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+
+					std::cout << (pScene == &closeScene ? "close vehicle: " : "vehicle grid: ") << elapsed.count() / frames << " ms/frame, resolve "
+						<< resolveMilliseconds / frames << " ms/frame" << std::endl;
+				}
+			}
+
+			SDL_DestroyWindow(pWindow);
+		}
+	
+		void PixelPacking()
+		{
+			const int frames{ 5 };
+			const int resolutions[][2]{ { 1920, 1080 }, { 3840, 2160 } };
+
+			std::cout << "--- PixelPacking ---" << std::endl;
+
+			// A wall right in front of the camera covers every pixel with two triangles, so the cost is in the pixels
+			const auto pWall = std::make_shared<const Mesh>(CreateBoxMesh({ 400.0f, 200.0f, 1.0f }));
+
+			for (const auto& resolution : resolutions)
+			{
+				SDL_Window* pWindow = CreateBenchmarkWindow(resolution[0], resolution[1]);
+				if (!pWindow) return;
+
+				{
+					Renderer renderer{ pWindow };
+					renderer.ToggleDebugDepthBuffer();
+
+					Scene scene{};
+					InitializeBenchmarkCamera(scene, renderer.GetAspectRatio());
+					scene.AddShadableObject({ pWall, std::make_shared<LambertShader>() }, Matrix::CreateTranslation(0.0f, -95.0f, -50.0f));
+
+					renderer.Render(&scene);
+
+					double resolveMilliseconds{};
+
+					const auto start = Clock::now();
+					for (int frame = 0; frame < frames; ++frame)
+					{
+						renderer.Invalidate();
+						renderer.Render(&scene);
+						resolveMilliseconds += renderer.GetStatistics().resolveMilliseconds;
+					}
+					const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+
+					std::cout << resolution[0] << "x" << resolution[1] << ": " << elapsed.count() / frames << " ms/frame, conversion to the back buffer "
+						<< resolveMilliseconds / frames << " ms/frame" << std::endl;
+				}
+
+				SDL_DestroyWindow(pWindow);
+			}
+		}
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+namespace dae
+{
+	namespace Benchmarks
+	{
+		// Runs every benchmark and prints the results to the console
+		void RunAll();
+
+		// Parses the reference OBJ files repeatedly and reports the parser throughput in MB/s
+		void ParseOBJ();
+
+		// Reports the post-transform cache ACMR of the reference meshes before and after optimization
+		void VertexCache();
+
+		// Compares loading the reference meshes from OBJ (parse + optimize) against reading their binary cache
+		void LoadMesh();
+
+		// Reports the geometry memory and vertex stage throughput of float and quantized vertex streams
+		void QuantizedVertices();
+
+		// Compares the size and load time of the OBJ, the raw cache and the compressed quantized cache
+		void MeshCompression();
+
+		// Renders a crowd of vehicles receding from the camera with and without distance based LOD selection
+		void CrowdLOD();
+
+		// Renders the vehicle from all sides with and without meshlet culling, reporting the transformed vertices and culled meshlets
+		void Meshlets();
+
+		// Renders a ring of vehicles around the camera, reporting how many objects the frustum culls before the vertex stage
+		void FrustumCulling();
+
+		// Compares culling a large grid of props through the scene BVH against testing every object, and times building and refitting it
+		void SceneIndex();
+
+		// Renders a street of vehicles behind a row of buildings with and without occlusion culling
+		void OcclusionCulling();
+
+		// Times updating the transforms of a two level hierarchy when nothing, a few groups and every group moved
+		void SceneGraph();
+
+		// Renders a grid of vehicles while nothing, only the camera and only one vehicle moves, reporting the vertices the renderer could reuse
+		void StaticFrames();
+
+		// Renders a grid of vehicles while nothing and while one vehicle moves, drawing full frames and only the dirty rects
+		void IncrementalRendering();
+
+		// Renders a grid of vehicles as one frame, as scissored tiles of that frame and as two split screen viewports
+		void Viewports();
+
+		// Times frames at 1080p and 4K of an empty scene and of a single small object, where clearing the buffers is most of the work
+		void FrameClears();
+
+		// Times frames of a deep scene in each depth format and prints its size and the smallest resolvable distance step at a few distances
+		void DepthFormats();
+
+		// Times full frames at 1080p of a vehicle filling the screen and of a grid of vehicles, and how much of it the copy of the pixel tiles to the back buffer takes
+		void PixelTiles();
+
+		// Times frames of a wall covering the screen in the depth view, where writing the pixels is most of the work
+		void PixelPacking();
+	}
+}
@@ -2,7 +2,7 @@
 
 #include "ReferenceScene.h"
 #include "LambertShader.h"
-#include "Utils.h"
+#include "MeshCache.h"
 
 namespace dae
 {
@@ -16,8 +16,15 @@ namespace dae
 		// Create space scooter
 		ShadableObject spaceScooter{};
 
-		Utils::ParseOBJ("Resources/vehicle.obj", spaceScooter.mesh.vertices, spaceScooter.mesh.indices);
-		spaceScooter.mesh.primitiveTopology = PrimitiveTopology::TriangleList;
+		MeshCache::LoadOptions loadOptions{};
+		loadOptions.stripify = true;
+		loadOptions.primitiveRestart = true;
+		loadOptions.generateLODs = true;
+		loadOptions.buildMeshlets = true;
+
+		auto pMesh = std::make_shared<Mesh>();
+		MeshCache::LoadOBJ("Resources/vehicle.obj", *pMesh, loadOptions);
+		spaceScooter.pMesh = pMesh;
 
 		auto pLitShader = std::make_shared<LambertShader>();
 
@@ -29,7 +36,7 @@ namespace dae
 
 		spaceScooter.pShader = pLitShader;
 
-		m_pSpaceScooter = AddShadableObject(spaceScooter);
+		m_SpaceScooter = AddShadableObject(spaceScooter);
 	}
 
 	void ReferenceScene::Update(Timer* pTimer)
@@ -39,7 +46,8 @@ namespace dae
 		if (m_DebugRotate)
 		{
 			const float rotationSpeed = 1.0f;
-			m_pSpaceScooter->mesh.worldMatrix = Matrix::CreateRotationY(rotationSpeed * pTimer->GetElapsed()) * m_pSpaceScooter->mesh.worldMatrix;
+			m_Rotation += rotationSpeed * pTimer->GetElapsed();
+			SetLocalMatrix(m_SpaceScooter, Matrix::CreateRotationY(m_Rotation));
 		}
 	}
 
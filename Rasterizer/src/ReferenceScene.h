@@ -20,7 +20,8 @@ namespace dae
 		void OnEvent(const SDL_Event& e) override;
 
 	private:
-		ShadableObject* m_pSpaceScooter{ nullptr };
+		ObjectHandle m_SpaceScooter{};
+		float m_Rotation{};
 
 		bool m_DebugRotate{};
 	};
@@ -7,14 +7,77 @@
 #include "Texture.h"
 #include "Utils.h"
 #include "Scene.h"
+#include "Quantization.h"
 
+#include <immintrin.h>
+
+#include <algorithm>
+#include <chrono>
 #include <execution>
+#include <functional>
 #include <ranges>
 
 namespace dae
 {
+	namespace
+	{
+		// Projected simplification error, in pixels, below which a coarser level of detail is used
+		constexpr float LOD_PIXEL_ERROR{ 1.0f };
+		// A coarser level is only taken when its error is this fraction of the limit, so objects near a switch distance do not flicker between levels
+		constexpr float LOD_HYSTERESIS{ 0.75f };
+
+		// Resolution of the occlusion buffer, the width a multiple of 4
+		constexpr int OCCLUSION_BUFFER_WIDTH{ 256 };
+		constexpr int OCCLUSION_BUFFER_HEIGHT{ 128 };
+
+		// Pixels along each side of the tiles that are cleared on their first write
+		constexpr int CLEAR_TILE_SIZE{ 32 };
+
+		// Above this fraction of the screen, the dirty rects are drawn as a full frame
+		constexpr float MAX_DIRTY_AREA{ 0.5f };
+
+		bool IsEmpty(const ScreenRect& rect)
+		{
+			return rect.left >= rect.right || rect.top >= rect.bottom;
+		}
+
+		bool Overlaps(const ScreenRect& a, const ScreenRect& b)
+		{
+			return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+		}
+
+		// Empty, but not necessarily with zero extents, when they do not overlap
+		ScreenRect Intersect(const ScreenRect& a, const ScreenRect& b)
+		{
+			return { std::max(a.left, b.left), std::max(a.top, b.top), std::min(a.right, b.right), std::min(a.bottom, b.bottom) };
+		}
+
+		ScreenRect Merge(const ScreenRect& a, const ScreenRect& b)
+		{
+			return { std::min(a.left, b.left), std::min(a.top, b.top), std::max(a.right, b.right), std::max(a.bottom, b.bottom) };
+		}
+
+		// Vertices the cache takes before further objects are transformed every frame, about 80 bytes each
+		constexpr size_t VERTEX_CACHE_SIZE{ 1 << 20 };
+
+		// Colors of the pixel tiles are RGBA8, red in the lowest byte and alpha unused
+		constexpr uint32_t PackRGBA8(uint8_t r, uint8_t g, uint8_t b)
+		{
+			return r | g << 8 | b << 16;
+		}
+
+		// Channels are truncated like a cast to uint8_t, and saturated to [0, 255] by the packs
+		uint32_t PackRGBA8(const ColorRGB& color)
+		{
+			const __m128i channels = _mm_cvttps_epi32(_mm_mul_ps(_mm_setr_ps(color.r, color.g, color.b, 0.0f), _mm_set1_ps(255.0f)));
+			const __m128i words = _mm_packs_epi32(channels, channels);
+			return static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(words, words)));
+		}
+	}
+
 	Renderer::Renderer(SDL_Window* pWindow) :
-		m_pWindow(pWindow)
+		m_pWindow(pWindow),
+		m_OcclusionBuffer(OCCLUSION_BUFFER_WIDTH, OCCLUSION_BUFFER_HEIGHT)
 	{
 		//Initialize
 		SDL_GetWindowSize(pWindow, &m_Width, &m_Height);
@@ -25,43 +88,232 @@ namespace dae
 		m_pBackBuffer = SDL_CreateRGBSurface(0, m_Width, m_Height, 32, 0, 0, 0, 0);
 		m_pBackBufferPixels = (uint32_t*)m_pBackBuffer->pixels;
 
-		m_pDepthBuffer = std::make_unique<float[]>(m_Width * m_Height);
+		AllocatePixelTiles();
+
+		// The back buffer format is fixed, colors are converted to it with these at present
+		const SDL_PixelFormat* pFormat = m_pBackBuffer->format;
+		assert(pFormat->BytesPerPixel == 4 && pFormat->Rloss == 0 && pFormat->Gloss == 0 && pFormat->Bloss == 0 && "back buffer channels are not 8 bit");
+
+		m_BackBufferShifts[0] = pFormat->Rshift;
+		m_BackBufferShifts[1] = pFormat->Gshift;
+		m_BackBufferShifts[2] = pFormat->Bshift;
+		m_BackBufferAlphaMask = pFormat->Amask;
+
+		m_ClearColor = PackRGBA8(100, 100, 100);
+		m_BackBufferClearColor = SDL_MapRGB(pFormat, 100, 100, 100);
+
+		// Nothing was written yet, but the back buffer pixels are not the clear color
+		m_TilesX = (m_Width + CLEAR_TILE_SIZE - 1) / CLEAR_TILE_SIZE;
+		m_TilesY = (m_Height + CLEAR_TILE_SIZE - 1) / CLEAR_TILE_SIZE;
+		m_TileStates.assign(static_cast<size_t>(m_TilesX) * m_TilesY, TileState::Pending);
+
+		m_Viewport = { 0, 0, m_Width, m_Height };
+		m_ScissorRect = m_Viewport;
 	}
 
 	void Renderer::Render(Scene* pScene)
+	{
+		const ScreenRect screen{ 0, 0, m_Width, m_Height };
+		Render(pScene, screen, screen);
+	}
+
+	void Renderer::Render(Scene* pScene, const ScreenRect& viewport, const ScreenRect& scissorRect)
 	{
 		//@START
-		SDL_FillRect(m_pBackBuffer, nullptr, SDL_MapRGB(m_pBackBuffer->format, 100, 100, 100));
-		std::fill_n(m_pDepthBuffer.get(), m_Width * m_Height, FLT_MAX);
+		m_Statistics = {};
+
+		// Nothing outside the viewport or the back buffer is touched
+		const ScreenRect screen{ 0, 0, m_Width, m_Height };
+		const ScreenRect clipRect = Intersect(Intersect(scissorRect, viewport), screen);
+
+		const Camera& camera = pScene->GetCamera();
+		const Matrix viewProjection = camera.viewMatrix * camera.projectionMatrix;
+
+		// Reversed Z takes a projection of its own for the vertices and the depth buffer
+		// Culling, LOD selection, occlusion and the screen rects of objects keep using the one of the camera
+		const Matrix depthViewProjection = (m_DepthFormat == DepthFormat::ReversedFloat32)
+			? camera.viewMatrix * Matrix::CreatePerspectiveFovLHReversedZ(camera.fov, camera.aspectRatio, camera.nearPlane, camera.farPlane)
+			: viewProjection;
+
+		if (!(depthViewProjection == m_FrameViewProjection) || !(camera.origin == m_FrameCameraOrigin) || viewport != m_Viewport) ++m_CameraVersion;
+
+		m_FrameViewProjection = depthViewProjection;
+		m_FrameCullingViewProjection = viewProjection;
+		m_FrameCameraOrigin = camera.origin;
+		m_Viewport = viewport;
+		m_ScissorRect = clipRect;
+
+		const Frustum frustum = Frustum::FromMatrix(viewProjection);
+
+		// Only moved subtrees are recomputed, then objects outside the frustum never reach the vertex stage
+		pScene->UpdateTransforms();
+		pScene->UpdateSpatialIndex();
+
+		m_VisibleObjects.clear();
+		pScene->QueryFrustum(frustum, m_VisibleObjects);
+
+		m_Statistics.culledObjects = pScene->GetShadableObjectCount() - m_VisibleObjects.size();
+
+		// Objects hidden behind occluders do not reach the vertex stage either
+		if (m_IsOcclusionCullingEnabled) CullOccludedObjects(camera, *pScene);
+
+		m_Statistics.drawnObjects = m_VisibleObjects.size();
+
+		const std::span<ShadableObject> objects = pScene->GetShadableObjects();
+		const std::span<const Matrix> worldMatrices = pScene->GetWorldMatrices();
+		const std::span<const uint32_t> worldVersions = pScene->GetWorldVersions();
+
+		// Handles of another scene name other objects
+		const bool isSceneChanged = pScene->GetId() != m_VertexCacheSceneId;
+		if (isSceneChanged)
+		{
+			m_VertexCache.clear();
+			m_CachedSlots.clear();
+			m_CachedVertexCount = 0;
+			m_UncachedVertices = {};
+			m_VertexCacheSceneId = pScene->GetId();
+		}
+
+		// Instances of a mesh are drawn back to back, so its geometry stays in cache while they are transformed
+		// Otherwise objects keep their storage order, so the arrays of the scene are read front to back
+		std::sort(m_VisibleObjects.begin(), m_VisibleObjects.end(), [&](uint32_t left, uint32_t right)
+		{
+			const Mesh* pLeft = objects[left].pMesh.get();
+			const Mesh* pRight = objects[right].pMesh.get();
+			return (pLeft != pRight) ? std::less<const Mesh*>{}(pLeft, pRight) : left < right;
+		});
+
+		// With the camera still, only the parts of the frame where objects changed are drawn again
+		const bool isCameraChanged = m_CameraVersion != m_DrawnCameraVersion;
+		m_DrawnCameraVersion = m_CameraVersion;
+
+		const bool isDirtyAreaSmall = FindDirtyRects(*pScene);
+
+		// Drawing part of the screen leaves the rest for the dirty rects to find, so the next whole screen is drawn in full
+		const bool isWholeScreen = viewport == screen && clipRect == screen;
+
+		const bool isFullFrame = !m_IsIncrementalRenderingEnabled || m_IsFrameInvalid || !isWholeScreen || isSceneChanged || isCameraChanged || !isDirtyAreaSmall;
+		m_IsFrameInvalid = !isWholeScreen;
+
+		if (isFullFrame)
+		{
+			m_DirtyRects.clear();
+			if (!IsEmpty(clipRect)) m_DirtyRects.push_back(clipRect);
+		}
 
 		//Lock BackBuffer
 		SDL_LockSurface(m_pBackBuffer);
 
-		for (ShadableObject& object : pScene->GetShadableObjects())
+		for (const ScreenRect& rect : m_DirtyRects)
+		{
+			ClearRect(rect);
+			m_Statistics.redrawnPixels += static_cast<size_t>(rect.right - rect.left) * (rect.bottom - rect.top);
+		}
+
+		for (size_t visible = 0; visible < m_VisibleObjects.size(); ++visible)
 		{
+			const uint32_t index = m_VisibleObjects[visible];
+
+			ShadableObject& object = objects[index];
+			if (!object.pMesh) continue;
+
+			// Untouched by the dirty rects, its pixels are still on screen
+			const ScreenRect& objectRect = m_VisibleRects[visible];
+			if (std::none_of(m_DirtyRects.begin(), m_DirtyRects.end(), [&](const ScreenRect& rect) { return Overlaps(rect, objectRect); })) continue;
+
+			const Matrix& world = worldMatrices[index];
+
 			m_pCurrentShader = object.pShader.get();
+			m_CurrentStencil = object.stencil;
+
+			const Mesh& mesh = *object.pMesh;
+
+			// Without a LOD chain the whole mesh is drawn
+			const size_t indexCount = mesh.indices16.empty() ? mesh.indices.size() : mesh.indices16.size();
+			const size_t vertexCount = mesh.quantizedVertices.empty() ? mesh.vertices.size() : mesh.quantizedVertices.size();
+			const MeshLOD lod = mesh.lods.empty()
+				? MeshLOD{ 0, static_cast<uint32_t>(indexCount), static_cast<uint32_t>(vertexCount), 0.0f, 0, static_cast<uint32_t>(mesh.meshlets.size()) }
+				: mesh.lods[SelectLOD(camera, object, world)];
+
+			const auto vertexStageStart = std::chrono::high_resolution_clock::now();
+
+			CachedVertices& cache = GetCachedVertices(pScene->GetHandle(index), mesh, worldVersions[index], lod.vertexCount);
 
-			VertexTransformationFunction(pScene->GetCamera(), object.mesh);
+			if (mesh.meshlets.empty())
+			{
+				const size_t transformedCount = VertexTransformationFunction(camera, mesh, world, lod.vertexCount, cache);
+				m_Statistics.transformedVertices += transformedCount;
+				m_Statistics.skippedVertices += lod.vertexCount - transformedCount;
+			}
+			else
+			{
+				CullMeshlets(camera, frustum, mesh, world, lod);
+				m_Statistics.transformedVertices += TransformVisibleMeshlets(camera, mesh, world, cache);
+			}
 
-			switch (object.mesh.primitiveTopology)
+			m_pVerticesOut = cache.vertices.data();
+
+			const std::chrono::duration<double, std::milli> vertexStageTime = std::chrono::high_resolution_clock::now() - vertexStageStart;
+			m_Statistics.vertexStageMilliseconds += vertexStageTime.count();
+
+			for (const ScreenRect& rect : m_DirtyRects)
 			{
-				case PrimitiveTopology::TriangleList:
-					RasterizeTriangleList(object.mesh);
-					break;
+				if (!Overlaps(rect, objectRect)) continue;
 
-				case PrimitiveTopology::TriangleStrip:
-					RasterizeTriangleStrip(object.mesh);
-					break;
+				m_ScissorRect = rect;
+				RasterizeObject(mesh, lod);
 			}
 
 			m_pCurrentShader = nullptr;
+			m_pVerticesOut = nullptr;
 		}
 
+		m_ScissorRect = clipRect;
+
+		// Objects not drawn in a partial frame still hold on to their vertices
+		if (isFullFrame) TrimVertexCache();
+
+		// The depth buffer is complete, answer the queries issued for this frame
+		m_QueryResults.clear();
+		for (const Bounds& bounds : m_PendingQueries)
+		{
+			m_QueryResults.push_back(CountVisibleSamples(bounds));
+		}
+		m_PendingQueries.clear();
+		++m_FrameIndex;
+
+		// The back buffer receives what was drawn and the clear color of the tiles no triangle reached
+		const auto resolveStart = std::chrono::high_resolution_clock::now();
+		for (const ScreenRect& rect : m_DirtyRects)
+		{
+			ResolveRect(rect);
+		}
+
+		const std::chrono::duration<double, std::milli> resolveTime = std::chrono::high_resolution_clock::now() - resolveStart;
+		m_Statistics.resolveMilliseconds = resolveTime.count();
+
 		//@END
 		//Update SDL Surface
 		SDL_UnlockSurface(m_pBackBuffer);
-		SDL_BlitSurface(m_pBackBuffer, nullptr, m_pFrontBuffer, nullptr);
-		SDL_UpdateWindowSurface(m_pWindow);
+
+		if (isFullFrame && isWholeScreen)
+		{
+			SDL_BlitSurface(m_pBackBuffer, nullptr, m_pFrontBuffer, nullptr);
+			SDL_UpdateWindowSurface(m_pWindow);
+		}
+		else if (!m_DirtyRects.empty())
+		{
+			// Only the redrawn rectangles reach the window
+			std::vector<SDL_Rect> areas{};
+			for (const ScreenRect& rect : m_DirtyRects)
+			{
+				SDL_Rect area{ rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top };
+				SDL_BlitSurface(m_pBackBuffer, &area, m_pFrontBuffer, &area);
+				areas.push_back(area);
+			}
+
+			SDL_UpdateWindowSurfaceRects(m_pWindow, areas.data(), static_cast<int>(areas.size()));
+		}
 	}
 
 	bool Renderer::SaveBufferToImage() const
@@ -77,75 +329,866 @@ namespace dae
 	void Renderer::ToggleDebugDepthBuffer()
 	{
 		m_DebugDepthBuffer = !m_DebugDepthBuffer;
+		m_IsFrameInvalid = true;
+	}
+
+	void Renderer::SetDepthFormat(DepthFormat format)
+	{
+		if (format == m_DepthFormat) return;
+
+		m_DepthFormat = format;
+		AllocatePixelTiles();
+
+		// Written pixels are lost, the next frame starts over
+		std::replace(m_TileStates.begin(), m_TileStates.end(), TileState::Written, TileState::Pending);
+		m_IsFrameInvalid = true;
+	}
+
+	DepthFormat Renderer::GetDepthFormat() const
+	{
+		return m_DepthFormat;
+	}
+
+	uint8_t Renderer::GetStencil(int x, int y) const
+	{
+		if (m_DepthFormat != DepthFormat::Unorm24Stencil8 || x < 0 || y < 0 || x >= m_Width || y >= m_Height) return 0;
+		if (m_TileStates[x / CLEAR_TILE_SIZE + y / CLEAR_TILE_SIZE * m_TilesX] != TileState::Written) return 0;
+
+		return DepthEncoding::Unorm24Stencil8::GetStencil(GetTileDepths<DepthEncoding::Unorm24Stencil8>(GetPixelTile(x, y))[GetTilePixelIndex(x, y)]);
+	}
+
+	void Renderer::ToggleIncrementalRendering()
+	{
+		m_IsIncrementalRenderingEnabled = !m_IsIncrementalRenderingEnabled;
+		m_IsFrameInvalid = true;
+	}
+
+	void Renderer::Invalidate()
+	{
+		m_IsFrameInvalid = true;
+	}
+
+	void Renderer::ToggleOcclusionCulling()
+	{
+		m_IsOcclusionCullingEnabled = !m_IsOcclusionCullingEnabled;
+	}
+
+	const RenderStatistics& Renderer::GetStatistics() const
+	{
+		return m_Statistics;
+	}
+
+	OcclusionQuery Renderer::IssueOcclusionQuery(const Bounds& worldBounds)
+	{
+		m_PendingQueries.push_back(worldBounds);
+		return { m_FrameIndex, static_cast<uint32_t>(m_PendingQueries.size() - 1) };
+	}
+
+	bool Renderer::GetOcclusionQueryResult(const OcclusionQuery& query, size_t& visibleSamples) const
+	{
+		// Answers of the last frame only
+		if (query.frame + 1 != m_FrameIndex || query.index >= m_QueryResults.size()) return false;
+
+		visibleSamples = m_QueryResults[query.index];
+		return true;
 	}
 
-	void Renderer::VertexTransformationFunction(const Camera& camera, Mesh& mesh) const
+	size_t Renderer::CountVisibleSamples(const Bounds& worldBounds) const
 	{
-		const auto& verticesIn = mesh.vertices;
-		auto& verticesOut = mesh.vertices_out;
+		if (worldBounds.IsEmpty()) return 0;
+
+		const Vector3& min = worldBounds.min;
+		const Vector3& max = worldBounds.max;
+
+		Vector4 corners[8]{};
+		for (int corner = 0; corner < 8; ++corner)
+		{
+			corners[corner] = ProjectToScreen(m_FrameViewProjection, {
+				(corner & 1) ? max.x : min.x,
+				(corner & 2) ? max.y : min.y,
+				(corner & 4) ? max.z : min.z
+			});
 
-		Matrix wvp = mesh.worldMatrix * camera.viewMatrix * camera.projectionMatrix;
+			// Triangles reaching behind the camera are not drawn, so a box through the near plane counts as covering the scissor rect
+			if (IsBeforeNearPlane(corners[corner]))
+			{
+				return IsEmpty(m_ScissorRect) ? 0 : static_cast<size_t>(m_ScissorRect.right - m_ScissorRect.left) * (m_ScissorRect.bottom - m_ScissorRect.top);
+			}
+		}
 
-		verticesOut.resize(verticesIn.size());
+		// Only the faces turned towards the camera, they cover the box without overlapping. Corners of each face in strip order
+		const int faces[6][4]{ { 0, 2, 4, 6 }, { 1, 3, 5, 7 }, { 0, 1, 4, 5 }, { 2, 3, 6, 7 }, { 0, 1, 2, 3 }, { 4, 5, 6, 7 } };
+		const bool isFacing[6]{
+			m_FrameCameraOrigin.x < min.x, m_FrameCameraOrigin.x > max.x,
+			m_FrameCameraOrigin.y < min.y, m_FrameCameraOrigin.y > max.y,
+			m_FrameCameraOrigin.z < min.z, m_FrameCameraOrigin.z > max.z
+		};
 
-		for (size_t i = 0; i < verticesIn.size(); ++i)
+		size_t samples{};
+		for (int face = 0; face < 6; ++face)
 		{
-			Vertex_Out& vertex = verticesOut[i];
+			if (!isFacing[face]) continue;
+
+			const int* pCorners = faces[face];
+			samples += CountVisibleSamples(corners[pCorners[0]], corners[pCorners[1]], corners[pCorners[2]]);
+			samples += CountVisibleSamples(corners[pCorners[1]], corners[pCorners[3]], corners[pCorners[2]]);
+		}
+
+		return samples;
+	}
 
-			// Convert Vertex to Vertex_Out
-			vertex.position = { verticesIn[i].position, 0.0f };
-			vertex.color = verticesIn[i].color;
-			vertex.uv = verticesIn[i].uv;
-			vertex.normal = mesh.worldMatrix.TransformVector(verticesIn[i].normal);
-			vertex.tangent = mesh.worldMatrix.TransformVector(verticesIn[i].tangent);
+	void Renderer::ClearRect(const ScreenRect& rect)
+	{
+		const int firstTileX = rect.left / CLEAR_TILE_SIZE;
+		const int firstTileY = rect.top / CLEAR_TILE_SIZE;
+		const int lastTileX = (rect.right - 1) / CLEAR_TILE_SIZE;
+		const int lastTileY = (rect.bottom - 1) / CLEAR_TILE_SIZE;
 
-			vertex.position = wvp.TransformPoint(vertex.position);
+		for (int tileY = firstTileY; tileY <= lastTileY; ++tileY)
+		{
+			for (int tileX = firstTileX; tileX <= lastTileX; ++tileX)
+			{
+				// A tile nothing was written to is still clear as a whole
+				TileState& state = m_TileStates[tileX + tileY * m_TilesX];
+				if (state != TileState::Written) continue;
 
-			Vector3 worldPosition = mesh.worldMatrix.TransformPoint(verticesIn[i].position);
-			vertex.viewDirection = (worldPosition - camera.origin).Normalized();
+				const ScreenRect tileRect = GetTileRect(tileX, tileY);
+				const ScreenRect area = Intersect(tileRect, rect);
 
-			// Perspective divide
-			vertex.position.x /= vertex.position.w;
-			vertex.position.y /= vertex.position.w;
-			vertex.position.z /= vertex.position.w;
+				// Tiles inside the rect wait for their first write, the part of a tile the rect cuts is cleared now
+				if (area == tileRect)
+				{
+					state = TileState::Pending;
+					continue;
+				}
 
-			// Transform to screen space
-			vertex.position.x = (vertex.position.x + 1) * 0.5f * m_Width;
-			vertex.position.y = (1 - vertex.position.y) * 0.5f * m_Height;
+				ClearPixels(area);
+			}
 		}
 	}
 
-	void Renderer::RasterizeTriangleStrip(const Mesh& mesh)
+	void Renderer::ClearTile(int tileX, int tileY)
+	{
+		ClearPixels(GetTileRect(tileX, tileY));
+		m_TileStates[tileX + tileY * m_TilesX] = TileState::Written;
+	}
+
+	void Renderer::ResolveRect(const ScreenRect& rect)
 	{
-		for (size_t i = 2; i < mesh.indices.size(); ++i)
+		if (IsEmpty(rect)) return;
+
+		// Rows of tiles write rows of the back buffer of their own
+		const auto tileRows = std::views::iota(rect.top / CLEAR_TILE_SIZE, (rect.bottom - 1) / CLEAR_TILE_SIZE + 1);
+		std::for_each(std::execution::par, tileRows.begin(), tileRows.end(), [&](int tileY)
 		{
-			size_t i0 = i - ((i % 2) == 0 ? 2 : 1);
-			size_t i1 = i - ((i % 2) == 0 ? 1 : 2);
-			size_t i2 = i;
+			for (int tileX = rect.left / CLEAR_TILE_SIZE; tileX <= (rect.right - 1) / CLEAR_TILE_SIZE; ++tileX)
+			{
+				TileState& state = m_TileStates[tileX + tileY * m_TilesX];
 
-			const Vertex_Out& v0 = mesh.vertices_out[mesh.indices[i0]];
-			const Vertex_Out& v1 = mesh.vertices_out[mesh.indices[i1]];
-			const Vertex_Out& v2 = mesh.vertices_out[mesh.indices[i2]];
+				const ScreenRect tileRect = GetTileRect(tileX, tileY);
+				const ScreenRect area = Intersect(tileRect, rect);
 
-			RasterizeTriangle(v0, v1, v2);
+				switch (state)
+				{
+					case TileState::Pending:
+						for (int y = area.top; y < area.bottom; ++y)
+						{
+							std::fill_n(m_pBackBufferPixels + y * m_Width + area.left, area.right - area.left, m_BackBufferClearColor);
+						}
+
+						if (area == tileRect) state = TileState::Resolved;
+						break;
+
+					case TileState::Resolved:
+						break;
+
+					case TileState::Written:
+						for (int y = area.top; y < area.bottom; ++y)
+						{
+							uint32_t* const pRow = m_pBackBufferPixels + y * m_Width;
+
+							for (int x = area.left; x < area.right;)
+							{
+								const uint32_t* const pColors = GetTileColors(GetPixelTile(x, y)) + GetTilePixelIndex(x, y);
+								const int count = std::min(PIXEL_TILE_SIZE - x % PIXEL_TILE_SIZE, area.right - x);
+
+								ConvertToBackBuffer(pColors, pRow + x, count);
+								x += count;
+							}
+						}
+						break;
+				}
+			}
+		});
+	}
+
+	ScreenRect Renderer::GetTileRect(int tileX, int tileY) const
+	{
+		return {
+			tileX * CLEAR_TILE_SIZE,
+			tileY * CLEAR_TILE_SIZE,
+			std::min((tileX + 1) * CLEAR_TILE_SIZE, m_Width),
+			std::min((tileY + 1) * CLEAR_TILE_SIZE, m_Height)
+		};
+	}
+
+	void Renderer::ConvertToBackBuffer(const uint32_t* pColors, uint32_t* pPixels, int count) const
+	{
+		const __m128i channelMask = _mm_set1_epi32(0xFF);
+		const __m128i alpha = _mm_set1_epi32(static_cast<int>(m_BackBufferAlphaMask));
+		const __m128i greenOffset = _mm_cvtsi32_si128(8);
+		const __m128i blueOffset = _mm_cvtsi32_si128(16);
+		const __m128i redShift = _mm_cvtsi32_si128(m_BackBufferShifts[0]);
+		const __m128i greenShift = _mm_cvtsi32_si128(m_BackBufferShifts[1]);
+		const __m128i blueShift = _mm_cvtsi32_si128(m_BackBufferShifts[2]);
+
+		// Four pixels at a time, every channel moved from its byte to its place in the back buffer format
+		int pixel{};
+		for (; pixel + 4 <= count; pixel += 4)
+		{
+			const __m128i colors = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pColors + pixel));
+
+			const __m128i red = _mm_sll_epi32(_mm_and_si128(colors, channelMask), redShift);
+			const __m128i green = _mm_sll_epi32(_mm_and_si128(_mm_srl_epi32(colors, greenOffset), channelMask), greenShift);
+			const __m128i blue = _mm_sll_epi32(_mm_and_si128(_mm_srl_epi32(colors, blueOffset), channelMask), blueShift);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pPixels + pixel), _mm_or_si128(_mm_or_si128(red, green), _mm_or_si128(blue, alpha)));
+		}
+
+		for (; pixel < count; ++pixel)
+		{
+			const uint32_t color = pColors[pixel];
+			pPixels[pixel] = (color & 0xFF) << m_BackBufferShifts[0] | (color >> 8 & 0xFF) << m_BackBufferShifts[1]
+				| (color >> 16 & 0xFF) << m_BackBufferShifts[2] | m_BackBufferAlphaMask;
+		}
+	}
+
+	void Renderer::ClearPixels(const ScreenRect& rect)
+	{
+		for (int tileTop = rect.top - rect.top % PIXEL_TILE_SIZE; tileTop < rect.bottom; tileTop += PIXEL_TILE_SIZE)
+		{
+			for (int tileLeft = rect.left - rect.left % PIXEL_TILE_SIZE; tileLeft < rect.right; tileLeft += PIXEL_TILE_SIZE)
+			{
+				std::byte* const pTile = GetPixelTile(tileLeft, tileTop);
+
+				const ScreenRect tileRect{ tileLeft, tileTop, tileLeft + PIXEL_TILE_SIZE, tileTop + PIXEL_TILE_SIZE };
+				const ScreenRect area = Intersect(tileRect, rect);
+
+				// Pixels past the edge of the screen belong to no rect, tiles they are in are still cleared as a whole
+				const bool isWholeTile = (area.left == tileLeft && area.top == tileTop && (area.right == tileRect.right || area.right == m_Width)
+					&& (area.bottom == tileRect.bottom || area.bottom == m_Height));
+
+				if (isWholeTile)
+				{
+					std::fill_n(GetTileColors(pTile), PIXEL_TILE_AREA, m_ClearColor);
+					ClearDepth(pTile, 0, PIXEL_TILE_AREA);
+					continue;
+				}
+
+				for (int y = area.top; y < area.bottom; ++y)
+				{
+					const int index = GetTilePixelIndex(area.left, y);
+					std::fill_n(GetTileColors(pTile) + index, area.right - area.left, m_ClearColor);
+					ClearDepth(pTile, index, area.right - area.left);
+				}
+			}
+		}
+	}
+
+	void Renderer::ClearDepth(std::byte* pTile, int index, int count)
+	{
+		switch (m_DepthFormat)
+		{
+			case DepthFormat::Float32:
+				std::fill_n(GetTileDepths<DepthEncoding::Float32>(pTile) + index, count, DepthEncoding::Float32::CLEAR);
+				break;
+
+			case DepthFormat::ReversedFloat32:
+				std::fill_n(GetTileDepths<DepthEncoding::ReversedFloat32>(pTile) + index, count, DepthEncoding::ReversedFloat32::CLEAR);
+				break;
+
+			case DepthFormat::Unorm16:
+				std::fill_n(GetTileDepths<DepthEncoding::Unorm16>(pTile) + index, count, DepthEncoding::Unorm16::CLEAR);
+				break;
+
+			case DepthFormat::Unorm24Stencil8:
+				std::fill_n(GetTileDepths<DepthEncoding::Unorm24Stencil8>(pTile) + index, count, DepthEncoding::Unorm24Stencil8::CLEAR);
+				break;
 		}
 	}
 
-	void Renderer::RasterizeTriangleList(const Mesh& mesh)
+	void Renderer::AllocatePixelTiles()
+	{
+		m_PixelTilesX = (m_Width + PIXEL_TILE_SIZE - 1) / PIXEL_TILE_SIZE;
+		const int pixelTilesY = (m_Height + PIXEL_TILE_SIZE - 1) / PIXEL_TILE_SIZE;
+
+		m_PixelTileStride = PIXEL_TILE_AREA * (sizeof(uint32_t) + GetDepthSize(m_DepthFormat));
+		m_pPixelTiles = std::make_unique<std::byte[]>(m_PixelTileStride * m_PixelTilesX * pixelTilesY);
+	}
+
+	bool Renderer::PassesDepthTest(int px, int py, float depth) const
 	{
-		assert(mesh.indices.size() % 3 == 0 && "incomplete triangles");
+		// Tiles that were not written are clear
+		if (m_TileStates[px / CLEAR_TILE_SIZE + py / CLEAR_TILE_SIZE * m_TilesX] != TileState::Written) return true;
 
-		for (size_t i = 0; i < mesh.indices.size(); i += 3)
+		std::byte* const pTile = GetPixelTile(px, py);
+		const int index = GetTilePixelIndex(px, py);
+
+		switch (m_DepthFormat)
 		{
-			const Vertex_Out& v0 = mesh.vertices_out[mesh.indices[i]];
-			const Vertex_Out& v1 = mesh.vertices_out[mesh.indices[i + 1]];
-			const Vertex_Out& v2 = mesh.vertices_out[mesh.indices[i + 2]];
+			case DepthFormat::Float32:
+				return DepthEncoding::Float32::Passes(DepthEncoding::Float32::Encode(depth), GetTileDepths<DepthEncoding::Float32>(pTile)[index]);
+
+			case DepthFormat::ReversedFloat32:
+				return DepthEncoding::ReversedFloat32::Passes(DepthEncoding::ReversedFloat32::Encode(depth), GetTileDepths<DepthEncoding::ReversedFloat32>(pTile)[index]);
+
+			case DepthFormat::Unorm16:
+				return DepthEncoding::Unorm16::Passes(DepthEncoding::Unorm16::Encode(depth), GetTileDepths<DepthEncoding::Unorm16>(pTile)[index]);
+
+			case DepthFormat::Unorm24Stencil8:
+				return DepthEncoding::Unorm24Stencil8::Passes(DepthEncoding::Unorm24Stencil8::Encode(depth), GetTileDepths<DepthEncoding::Unorm24Stencil8>(pTile)[index]);
+		}
+
+		return true;
+	}
+
+	bool Renderer::IsBeforeNearPlane(const Vector4& projected) const
+	{
+		if (projected.w < 0.0f) return true;
+		return (m_DepthFormat == DepthFormat::ReversedFloat32) ? projected.z > 1.0f : projected.z < 0.0f;
+	}
+
+	bool Renderer::FindDirtyRects(const Scene& scene)
+	{
+		const std::span<const ShadableObject> objects = scene.GetShadableObjects();
+		const std::span<const Bounds> worldBounds = scene.GetWorldBounds();
+		const std::span<const uint32_t> worldVersions = scene.GetWorldVersions();
+
+		m_DirtyRects.clear();
+		m_VisibleRects.clear();
+
+		const auto addDirtyRect = [&](const ScreenRect& rect)
+		{
+			if (!IsEmpty(rect)) m_DirtyRects.push_back(rect);
+		};
+
+		// An object that appeared, changed or moved on screen dirties where it was and where it is
+		for (uint32_t index : m_VisibleObjects)
+		{
+			const ShadableObject& object = objects[index];
+			const ObjectHandle handle = scene.GetHandle(index);
+			const ScreenRect rect = object.pMesh ? GetScreenRect(worldBounds[index]) : ScreenRect{};
+
+			m_VisibleRects.push_back(rect);
+
+			if (m_DrawnObjects.size() <= handle.slot) m_DrawnObjects.resize(handle.slot + 1);
+			DrawnObject& drawn = m_DrawnObjects[handle.slot];
+
+			// The slot can hold another object than last frame
+			const bool wasDrawn = drawn.frame + 1 == m_FrameIndex;
+			const bool isUnchanged = wasDrawn && drawn.handle == handle && drawn.pMesh == object.pMesh.get() && drawn.pShader == object.pShader.get()
+				&& drawn.worldVersion == worldVersions[index] && drawn.rect == rect;
+
+			if (!isUnchanged)
+			{
+				if (wasDrawn) addDirtyRect(drawn.rect);
+				addDirtyRect(rect);
+			}
+
+			drawn = { handle, object.pMesh.get(), object.pShader.get(), worldVersions[index], m_FrameIndex, rect };
+		}
+
+		// Objects that were removed, culled or occluded since leave their pixels behind
+		for (uint32_t slot : m_DrawnSlots)
+		{
+			const DrawnObject& drawn = m_DrawnObjects[slot];
+			if (drawn.frame + 1 == m_FrameIndex) addDirtyRect(drawn.rect);
+		}
+
+		m_DrawnSlots.clear();
+		for (uint32_t index : m_VisibleObjects)
+		{
+			m_DrawnSlots.push_back(scene.GetHandle(index).slot);
+		}
+
+		// Overlapping rects are merged until none overlap, so no pixel is cleared or drawn twice
+		for (size_t i = 0; i < m_DirtyRects.size(); ++i)
+		{
+			for (size_t j = i + 1; j < m_DirtyRects.size(); ++j)
+			{
+				if (!Overlaps(m_DirtyRects[i], m_DirtyRects[j])) continue;
+
+				m_DirtyRects[i] = Merge(m_DirtyRects[i], m_DirtyRects[j]);
+				m_DirtyRects.erase(m_DirtyRects.begin() + j);
+
+				// The grown rect can overlap rects that were checked against it before
+				j = i;
+			}
+		}
+
+		size_t dirtyArea{};
+		for (const ScreenRect& rect : m_DirtyRects)
+		{
+			dirtyArea += static_cast<size_t>(rect.right - rect.left) * (rect.bottom - rect.top);
+		}
+
+		return dirtyArea <= MAX_DIRTY_AREA * m_Width * m_Height;
+	}
+
+	ScreenRect Renderer::GetScreenRect(const Bounds& worldBounds) const
+	{
+		const ScreenRect screen{ 0, 0, m_Width, m_Height };
+		if (worldBounds.IsEmpty()) return screen;
+
+		const Vector3& min = worldBounds.min;
+		const Vector3& max = worldBounds.max;
+
+		Vector2 screenMin{ FLT_MAX, FLT_MAX };
+		Vector2 screenMax{ -FLT_MAX, -FLT_MAX };
+
+		for (int corner = 0; corner < 8; ++corner)
+		{
+			const Vector4 projected = ProjectToScreen(m_FrameCullingViewProjection, {
+				(corner & 1) ? max.x : min.x,
+				(corner & 2) ? max.y : min.y,
+				(corner & 4) ? max.z : min.z
+			});
+
+			// Projections of points behind the camera are meaningless
+			if (projected.w < 0.0f || projected.z < 0.0f) return screen;
+
+			screenMin.x = std::min(screenMin.x, projected.x);
+			screenMin.y = std::min(screenMin.y, projected.y);
+			screenMax.x = std::max(screenMax.x, projected.x);
+			screenMax.y = std::max(screenMax.y, projected.y);
+		}
+
+		// Every pixel whose center the box covers, clamped before the conversion so far away corners do not overflow
+		return {
+			static_cast<int>(std::floor(std::clamp(screenMin.x, 0.0f, static_cast<float>(m_Width)))),
+			static_cast<int>(std::floor(std::clamp(screenMin.y, 0.0f, static_cast<float>(m_Height)))),
+			static_cast<int>(std::ceil(std::clamp(screenMax.x, 0.0f, static_cast<float>(m_Width)))),
+			static_cast<int>(std::ceil(std::clamp(screenMax.y, 0.0f, static_cast<float>(m_Height))))
+		};
+	}
+
+	size_t Renderer::SelectLOD(const Camera& camera, ShadableObject& object, const Matrix& world) const
+	{
+		const Mesh& mesh = *object.pMesh;
+
+		// Screen pixels covered by one mesh unit at the distance of the object
+		const float scale = world.GetMaxScale();
+		const float distance = std::max((world.GetTranslation() - camera.origin).Magnitude(), camera.nearPlane);
+		const float pixelsPerUnit = scale * (m_Viewport.bottom - m_Viewport.top) / (2.0f * camera.fov * distance);
+
+		const auto isSharpEnough = [&](size_t lod, float limit)
+		{
+			return mesh.lods[lod].error * pixelsPerUnit <= limit;
+		};
+
+		size_t& lod = object.lod;
+		lod = std::min(lod, mesh.lods.size() - 1);
+
+		// Refine as soon as the error shows, coarsen only well below the limit
+		while (lod > 0 && !isSharpEnough(lod, LOD_PIXEL_ERROR)) --lod;
+		while (lod + 1 < mesh.lods.size() && isSharpEnough(lod + 1, LOD_PIXEL_ERROR * LOD_HYSTERESIS)) ++lod;
+
+		return lod;
+	}
+
+	Renderer::CachedVertices& Renderer::GetCachedVertices(ObjectHandle handle, const Mesh& mesh, uint32_t worldVersion, size_t vertexCount)
+	{
+		if (m_VertexCache.size() <= handle.slot) m_VertexCache.resize(handle.slot + 1);
+
+		CachedVertices* pCache = &m_VertexCache[handle.slot];
+
+		// A new entry, or the growth of one to a finer level or a larger mesh in its slot, has to fit in the cache
+		// An entry that cannot grow is left alone this frame, and trimmed unless drawn again
+		const size_t cachedCount = pCache->states.size();
+		if (cachedCount < vertexCount)
+		{
+			if (m_CachedVertexCount + vertexCount - cachedCount <= VERTEX_CACHE_SIZE)
+			{
+				m_CachedVertexCount += vertexCount - cachedCount;
+				if (cachedCount == 0) m_CachedSlots.push_back(handle.slot);
+			}
+			else
+			{
+				pCache = &m_UncachedVertices;
+			}
+		}
+
+		CachedVertices& cache = *pCache;
+
+		// Nothing of another object or an earlier world matrix is valid, an earlier projection only keeps the world space part
+		if (cache.handle != handle || cache.pMesh != &mesh || cache.worldVersion != worldVersion)
+		{
+			std::fill(cache.states.begin(), cache.states.end(), VertexState::Outdated);
+		}
+		else if (cache.cameraVersion != m_CameraVersion)
+		{
+			std::replace(cache.states.begin(), cache.states.end(), VertexState::Projected, VertexState::WorldSpace);
+		}
+
+		cache.handle = handle;
+		cache.pMesh = &mesh;
+		cache.worldVersion = worldVersion;
+		cache.cameraVersion = m_CameraVersion;
+		cache.frame = m_FrameIndex;
+
+		// A finer level adds vertices behind those of the coarser ones
+		if (cache.states.size() < vertexCount)
+		{
+			cache.vertices.resize(vertexCount);
+			cache.worldPositions.resize(vertexCount);
+			cache.states.resize(vertexCount, VertexState::Outdated);
+		}
+
+		return cache;
+	}
+
+	void Renderer::TrimVertexCache()
+	{
+		m_CachedVertexCount = 0;
+
+		std::erase_if(m_CachedSlots, [&](uint32_t slot)
+		{
+			CachedVertices& cache = m_VertexCache[slot];
+			if (cache.frame != m_FrameIndex)
+			{
+				cache = {};
+				return true;
+			}
+
+			m_CachedVertexCount += cache.states.size();
+			return false;
+		});
+	}
+
+	size_t Renderer::VertexTransformationFunction(const Camera& camera, const Mesh& mesh, const Matrix& world, size_t vertexCount, CachedVertices& cache)
+	{
+		size_t transformedCount{};
+
+		for (uint32_t i = 0; i < vertexCount; ++i)
+		{
+			if (TransformVertex(camera, mesh, world, i, cache)) ++transformedCount;
+		}
+
+		return transformedCount;
+	}
+
+	void Renderer::CullOccludedObjects(const Camera& camera, const Scene& scene)
+	{
+		const std::span<const ShadableObject> objects = scene.GetShadableObjects();
+		const std::span<const Matrix> worldMatrices = scene.GetWorldMatrices();
+		const std::span<const Bounds> worldBounds = scene.GetWorldBounds();
+		const std::span<const uint32_t> worldVersions = scene.GetWorldVersions();
+
+		const Matrix viewProjection = camera.viewMatrix * camera.projectionMatrix;
+
+		m_FrameOccluders.clear();
+		for (uint32_t index : m_VisibleObjects)
+		{
+			if (!objects[index].isOccluder || !objects[index].pMesh) continue;
+
+			m_FrameOccluders.push_back({ scene.GetHandle(index), objects[index].pMesh.get(), worldVersions[index] });
+		}
+
+		if (m_FrameOccluders.empty())
+		{
+			m_BufferOccluders.clear();
+			return;
+		}
+
+		const bool isBufferValid = m_FrameOccluders == m_BufferOccluders && m_OcclusionCameraVersion == m_CameraVersion && m_OcclusionSceneId == scene.GetId();
+		if (!isBufferValid)
+		{
+			m_OcclusionBuffer.Clear();
+
+			for (uint32_t index : m_VisibleObjects)
+			{
+				if (!objects[index].isOccluder || !objects[index].pMesh) continue;
+
+				m_OcclusionBuffer.RasterizeOccluder(*objects[index].pMesh, worldMatrices[index] * viewProjection);
+			}
+
+			m_OcclusionBuffer.Finalize();
+
+			std::swap(m_BufferOccluders, m_FrameOccluders);
+			m_OcclusionCameraVersion = m_CameraVersion;
+			m_OcclusionSceneId = scene.GetId();
+			++m_OcclusionBufferVersion;
+		}
+
+		// Occluders are always drawn, objects without bounds cannot be tested
+		// Objects that did not move keep their result while the buffer stays the same
+		const size_t visibleCount = m_VisibleObjects.size();
+		std::erase_if(m_VisibleObjects, [&](uint32_t index)
+		{
+			const Bounds& bounds = worldBounds[index];
+			if (objects[index].isOccluder || bounds.IsEmpty()) return false;
+
+			const ObjectHandle handle = scene.GetHandle(index);
+			if (handle.slot >= m_OcclusionResults.size()) m_OcclusionResults.resize(handle.slot + 1);
+
+			OcclusionResult& result = m_OcclusionResults[handle.slot];
+			if (result.handle != handle || result.worldVersion != worldVersions[index] || result.bufferVersion != m_OcclusionBufferVersion)
+			{
+				result = { handle, worldVersions[index], m_OcclusionBufferVersion, m_OcclusionBuffer.IsBoxOccluded(bounds.min, bounds.max, viewProjection) };
+				++m_Statistics.occlusionTests;
+			}
+
+			return result.isOccluded;
+		});
+
+		m_Statistics.occludedObjects = visibleCount - m_VisibleObjects.size();
+	}
+
+	void Renderer::CullMeshlets(const Camera& camera, const Frustum& frustum, const Mesh& mesh, const Matrix& world, const MeshLOD& lod)
+	{
+		const float scale = world.GetMaxScale();
+
+		m_VisibleMeshlets.clear();
+
+		for (uint32_t i = lod.meshletOffset; i < lod.meshletOffset + lod.meshletCount; ++i)
+		{
+			const Meshlet& meshlet = mesh.meshlets[i];
+
+			const Vector3 center = world.TransformPoint(meshlet.center);
+			const float radius = meshlet.radius * scale;
+
+			if (frustum.IsSphereOutside(center, radius))
+			{
+				++m_Statistics.culledMeshlets;
+				continue;
+			}
+
+			// Cone test in world space, exact for uniformly scaled objects
+			if (meshlet.coneCutoff < 1.0f)
+			{
+				const Vector3 toCenter = center - camera.origin;
+				const Vector3 axis = world.TransformVector(meshlet.coneAxis).Normalized();
+
+				if (Vector3::Dot(toCenter, axis) >= meshlet.coneCutoff * toCenter.Magnitude() + radius)
+				{
+					++m_Statistics.culledMeshlets;
+					continue;
+				}
+			}
+
+			m_VisibleMeshlets.push_back(&meshlet);
+		}
+
+		m_Statistics.visibleMeshlets += m_VisibleMeshlets.size();
+	}
+
+	size_t Renderer::TransformVisibleMeshlets(const Camera& camera, const Mesh& mesh, const Matrix& world, CachedVertices& cache)
+	{
+		m_IsVertexVisited.assign(cache.states.size(), false);
+
+		size_t transformedCount{};
+
+		for (const Meshlet* pMeshlet : m_VisibleMeshlets)
+		{
+			for (uint32_t i = pMeshlet->vertexOffset; i < pMeshlet->vertexOffset + pMeshlet->vertexCount; ++i)
+			{
+				// Vertices on the border of meshlets are shared with their neighbours
+				const uint32_t index = mesh.meshletVertices[i];
+				if (m_IsVertexVisited[index]) continue;
+
+				m_IsVertexVisited[index] = true;
+
+				if (TransformVertex(camera, mesh, world, index, cache)) ++transformedCount;
+				else ++m_Statistics.skippedVertices;
+			}
+		}
+
+		return transformedCount;
+	}
+
+	bool Renderer::TransformVertex(const Camera& camera, const Mesh& mesh, const Matrix& world, uint32_t index, CachedVertices& cache) const
+	{
+		VertexState& state = cache.states[index];
+		if (state == VertexState::Projected) return false;
+
+		Vertex_Out& vertex = cache.vertices[index];
+		Vector3& worldPosition = cache.worldPositions[index];
+
+		if (state == VertexState::Outdated)
+		{
+			// Quantized vertices are decoded here, so only the compact stream is read from memory
+			const Vertex vertexIn = mesh.quantizedVertices.empty()
+				? mesh.vertices[index]
+				: Quantization::DecodeVertex(mesh.quantizedVertices[index], mesh.quantizationBox);
+
+			vertex.color = vertexIn.color;
+			vertex.uv = vertexIn.uv;
+			vertex.normal = world.TransformVector(vertexIn.normal);
+			vertex.tangent = world.TransformVector(vertexIn.tangent);
+
+			worldPosition = world.TransformPoint(vertexIn.position);
+		}
+
+		// Only this part depends on the camera
+		vertex.position = ProjectToScreen(m_FrameViewProjection, worldPosition);
+		vertex.viewDirection = (worldPosition - camera.origin).Normalized();
+
+		state = VertexState::Projected;
+		return true;
+	}
+
+	Vector4 Renderer::ProjectToScreen(const Matrix& worldViewProjection, const Vector3& position) const
+	{
+		Vector4 projected = worldViewProjection.TransformPoint(Vector4{ position, 1.0f });
+
+		// Perspective divide
+		projected.x /= projected.w;
+		projected.y /= projected.w;
+		projected.z /= projected.w;
+
+		// Transform to the viewport
+		projected.x = m_Viewport.left + (projected.x + 1) * 0.5f * (m_Viewport.right - m_Viewport.left);
+		projected.y = m_Viewport.top + (1 - projected.y) * 0.5f * (m_Viewport.bottom - m_Viewport.top);
+
+		return projected;
+	}
+
+	void Renderer::RasterizeObject(const Mesh& mesh, const MeshLOD& lod)
+	{
+		if (mesh.meshlets.empty())
+		{
+			if (mesh.indices16.empty()) RasterizeMesh(mesh, mesh.indices, lod.indexOffset, lod.indexCount);
+			else RasterizeMesh(mesh, mesh.indices16, lod.indexOffset, lod.indexCount);
+		}
+		else
+		{
+			// Every meshlet is a complete strip or list on its own
+			for (const Meshlet* pMeshlet : m_VisibleMeshlets)
+			{
+				if (mesh.indices16.empty()) RasterizeMesh(mesh, mesh.indices, pMeshlet->indexOffset, pMeshlet->indexCount);
+				else RasterizeMesh(mesh, mesh.indices16, pMeshlet->indexOffset, pMeshlet->indexCount);
+			}
+		}
+	}
+
+	template<typename Index>
+	void Renderer::RasterizeMesh(const Mesh& mesh, const std::vector<Index>& indices, uint32_t indexOffset, uint32_t indexCount)
+	{
+		const std::span<const Index> range{ indices.data() + indexOffset, indexCount };
+
+		switch (mesh.primitiveTopology)
+		{
+			case PrimitiveTopology::TriangleList:
+				RasterizeTriangleList(range);
+				break;
+
+			case PrimitiveTopology::TriangleStrip:
+				RasterizeTriangleStrip(mesh, range);
+				break;
+		}
+	}
+
+	template<typename Index>
+	void Renderer::RasterizeTriangleStrip(const Mesh& mesh, std::span<const Index> indices)
+	{
+		// Screen space edge between consecutive strip vertices, each triangle reuses the edge it shares with the previous one
+		Vector2 sharedEdge{};
+
+		// Vertices since the start of the current strip, a restart index begins a new strip with even winding
+		size_t stripLength{};
+
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			if (mesh.primitiveRestart && indices[i] == PRIMITIVE_RESTART_INDEX<Index>)
+			{
+				stripLength = 0;
+				continue;
+			}
+
+			if (++stripLength < 2) continue;
+
+			const Index i1 = indices[i - 1];
+			const Index i2 = indices[i];
+
+			const Vector2 nextEdge = (m_pVerticesOut[i2].position - m_pVerticesOut[i1].position).GetXY();
+
+			if (stripLength >= 3)
+			{
+				const Index i0 = indices[i - 2];
+
+				// Degenerate triangles only join strips
+				if (i0 != i1 && i1 != i2 && i0 != i2)
+				{
+					const Vertex_Out& v0 = m_pVerticesOut[i0];
+					const Vertex_Out& v1 = m_pVerticesOut[i1];
+					const Vertex_Out& v2 = m_pVerticesOut[i2];
+
+					// Every second triangle of a strip swaps its first two vertices to keep the winding
+					if ((stripLength % 2) != 0)
+					{
+						RasterizeTriangle(v0, v1, v2, sharedEdge, nextEdge, -(sharedEdge + nextEdge));
+					}
+					else
+					{
+						RasterizeTriangle(v1, v0, v2, -sharedEdge, sharedEdge + nextEdge, -nextEdge);
+					}
+				}
+			}
+
+			sharedEdge = nextEdge;
+		}
+	}
+
+	template<typename Index>
+	void Renderer::RasterizeTriangleList(std::span<const Index> indices)
+	{
+		assert(indices.size() % 3 == 0 && "incomplete triangles");
+
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			const Vertex_Out& v0 = m_pVerticesOut[indices[i]];
+			const Vertex_Out& v1 = m_pVerticesOut[indices[i + 1]];
+			const Vertex_Out& v2 = m_pVerticesOut[indices[i + 2]];
 		
 			RasterizeTriangle(v0, v1, v2);
 		}
 	}
 
 	void Renderer::RasterizeTriangle(const Vertex_Out& v0, const Vertex_Out& v1, const Vertex_Out& v2)
+	{
+		// Calculate triangle edges
+		const Vector2 e0 = (v1.position - v0.position).GetXY();
+		const Vector2 e1 = (v2.position - v1.position).GetXY();
+		const Vector2 e2 = (v0.position - v2.position).GetXY();
+
+		RasterizeTriangle(v0, v1, v2, e0, e1, e2);
+	}
+
+	void Renderer::RasterizeTriangle(const Vertex_Out& v0, const Vertex_Out& v1, const Vertex_Out& v2, const Vector2& e0, const Vector2& e1, const Vector2& e2)
+	{
+		// Every format gets a loop of its own, so the depth test does not branch on it per pixel
+		switch (m_DepthFormat)
+		{
+			case DepthFormat::Float32:
+				RasterizeTriangle<DepthEncoding::Float32>(v0, v1, v2, e0, e1, e2);
+				break;
+
+			case DepthFormat::ReversedFloat32:
+				RasterizeTriangle<DepthEncoding::ReversedFloat32>(v0, v1, v2, e0, e1, e2);
+				break;
+
+			case DepthFormat::Unorm16:
+				RasterizeTriangle<DepthEncoding::Unorm16>(v0, v1, v2, e0, e1, e2);
+				break;
+
+			case DepthFormat::Unorm24Stencil8:
+				RasterizeTriangle<DepthEncoding::Unorm24Stencil8>(v0, v1, v2, e0, e1, e2);
+				break;
+		}
+	}
+
+	template<typename Depth>
+	void Renderer::RasterizeTriangle(const Vertex_Out& v0, const Vertex_Out& v1, const Vertex_Out& v2, const Vector2& e0, const Vector2& e1, const Vector2& e2)
 	{
 		if (m_pCurrentShader == nullptr) return;
 		if (v0.position.w < 0.0f || v1.position.w < 0.0f || v2.position.w < 0.0f) return;
@@ -156,17 +1199,25 @@ namespace dae
 		auto boxRight	= static_cast<int>(std::max({ v0.position.x, v1.position.x, v2.position.x })) + 1;
 		auto boxBottom	= static_cast<int>(std::max({ v0.position.y, v1.position.y, v2.position.y })) + 1;
 		
-		boxLeft			= std::max(0, boxLeft);
-		boxTop			= std::max(0, boxTop);
-		boxRight		= std::min(m_Width, boxRight);
-		boxBottom		= std::min(m_Height, boxBottom);
+		boxLeft			= std::max(m_ScissorRect.left, boxLeft);
+		boxTop			= std::max(m_ScissorRect.top, boxTop);
+		boxRight		= std::min(m_ScissorRect.right, boxRight);
+		boxBottom		= std::min(m_ScissorRect.bottom, boxBottom);
 
-		// Calculate triangle edges
-		const Vector2 e0 = (v1.position - v0.position).GetXY();
-		const Vector2 e1 = (v2.position - v1.position).GetXY();
-		const Vector2 e2 = (v0.position - v2.position).GetXY();
+		// Zero area triangles cover no pixels
+		const float totalWeight = Vector2::Cross(e0, -e2);
+		if (totalWeight == 0.0f || boxLeft >= boxRight || boxTop >= boxBottom) return;
+
+		// The tiles under the triangle are cleared before its depth test reads them
+		for (int tileY = boxTop / CLEAR_TILE_SIZE; tileY <= (boxBottom - 1) / CLEAR_TILE_SIZE; ++tileY)
+		{
+			for (int tileX = boxLeft / CLEAR_TILE_SIZE; tileX <= (boxRight - 1) / CLEAR_TILE_SIZE; ++tileX)
+			{
+				if (m_TileStates[tileX + tileY * m_TilesX] != TileState::Written) ClearTile(tileX, tileY);
+			}
+		}
 
-		const float invTotalWeight = 1.0f / Vector2::Cross(e0, -e2);
+		const float invTotalWeight = 1.0f / totalWeight;
 
 		// Loop variables
 		int pixelIndex = -1;
@@ -177,73 +1228,131 @@ namespace dae
 		Vertex_Out pixelVertex;
 		ColorRGB color;
 
+		// Pixel tile by pixel tile, so the colors and depth the triangle touches stay in cache
+		for (int tileTop = boxTop - boxTop % PIXEL_TILE_SIZE; tileTop < boxBottom; tileTop += PIXEL_TILE_SIZE)
+		{
+			for (int tileLeft = boxLeft - boxLeft % PIXEL_TILE_SIZE; tileLeft < boxRight; tileLeft += PIXEL_TILE_SIZE)
+			{
+				std::byte* const pTile = GetPixelTile(tileLeft, tileTop);
+				uint32_t* const pColors = GetTileColors(pTile);
+				typename Depth::Value* const pDepths = GetTileDepths<Depth>(pTile);
+
+				const int top		= std::max(boxTop, tileTop);
+				const int left		= std::max(boxLeft, tileLeft);
+				const int bottom	= std::min(boxBottom, tileTop + PIXEL_TILE_SIZE);
+				const int right		= std::min(boxRight, tileLeft + PIXEL_TILE_SIZE);
+
+				for (int py = top; py < bottom; ++py)
+				{
+					for (int px = left; px < right; ++px)
+					{
+						pixel.x = px + 0.5f;
+						pixel.y = py + 0.5f;
+
+						// Calculate vertex to pixel vectors
+						p0 = pixel - v0.position.GetXY();
+						p1 = pixel - v1.position.GetXY();
+						p2 = pixel - v2.position.GetXY();
+
+						// Barycentric cooridnates (weights)
+						w0 = Vector2::Cross(e1, p1) * invTotalWeight;
+						w1 = Vector2::Cross(e2, p2) * invTotalWeight;
+						w2 = Vector2::Cross(e0, p0) * invTotalWeight;
+
+						// Check sign equality
+						if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+
+						// Interpolate depth Z value using weights
+						depthZ = InterpolateDepth(w0, w1, w2, v0.position.z, v1.position.z, v2.position.z);
+
+						// Frustum culling
+						if (depthZ < 0.0f || depthZ > 1.0f) continue;
+
+						// Calculate pixel index
+						pixelIndex = GetTilePixelIndex(px, py);
+						assert(px >= 0 && px < m_Width && py >= 0 && py < m_Height && "buffer index out of bounds");
+
+						// Depth test
+						const typename Depth::Value depthValue = Depth::Encode(depthZ, m_CurrentStencil);
+						if (!Depth::Passes(depthValue, pDepths[pixelIndex])) continue;
+
+						// Interpolate depth W value using weights
+						depthW = 1.0f / (w0 / v0.position.w + w1 / v1.position.w + w2 / v2.position.w);
+
+						// Construct pixel vertex
+						pixelVertex.position = { static_cast<float>(px), static_cast<float>(py), depthZ, depthW };
+						pixelVertex.color = v0.color * w0 + v1.color * w1 + v2.color * w2;
+						pixelVertex.normal = (v0.normal * w0 + v1.normal * w1 + v2.normal * w2).Normalized();
+						pixelVertex.tangent = (v0.tangent * w0 + v1.tangent * w1 + v2.tangent * w2).Normalized();
+						pixelVertex.viewDirection = (v0.viewDirection * w0 + v1.viewDirection * w1 + v2.viewDirection * w2).Normalized();
+						pixelVertex.uv = (v0.uv / v0.position.w * w0 + v1.uv / v1.position.w * w1 + v2.uv / v2.position.w * w2) * depthW;
+
+						// Shade test
+						if (!m_pCurrentShader->CanShade(pixelVertex)) continue;
+
+						// Write depth value
+						pDepths[pixelIndex] = depthValue;
+
+						if (m_DebugDepthBuffer)
+						{
+							// Far is bright in every format
+							const float depth = (m_DepthFormat == DepthFormat::ReversedFloat32) ? 1.0f - depthZ : depthZ;
+							color.r = color.g = color.b = RemapDepth(depth, 0.985f, 1.0f);
+						}
+						else
+						{
+							color = m_pCurrentShader->Shade(pixelVertex);
+						}
+
+						pColors[pixelIndex] = PackRGBA8(color);
+					}
+				}
+			}
+		}
+	}
+
+	size_t Renderer::CountVisibleSamples(const Vector4& v0, const Vector4& v1, const Vector4& v2) const
+	{
+		if (v0.w < 0.0f || v1.w < 0.0f || v2.w < 0.0f) return 0;
+
+		const Vector2 e0 = (v1 - v0).GetXY();
+		const Vector2 e1 = (v2 - v1).GetXY();
+		const Vector2 e2 = (v0 - v2).GetXY();
+
+		const int boxLeft	= std::max(m_ScissorRect.left, static_cast<int>(std::min({ v0.x, v1.x, v2.x })) - 1);
+		const int boxTop	= std::max(m_ScissorRect.top, static_cast<int>(std::min({ v0.y, v1.y, v2.y })) - 1);
+		const int boxRight	= std::min(m_ScissorRect.right, static_cast<int>(std::max({ v0.x, v1.x, v2.x })) + 1);
+		const int boxBottom	= std::min(m_ScissorRect.bottom, static_cast<int>(std::max({ v0.y, v1.y, v2.y })) + 1);
+
+		const float totalWeight = Vector2::Cross(e0, -e2);
+		if (totalWeight == 0.0f) return 0;
+
+		const float invTotalWeight = 1.0f / totalWeight;
+
+		size_t samples{};
+
 		for (int py = boxTop; py < boxBottom; ++py)
 		{
 			for (int px = boxLeft; px < boxRight; ++px)
 			{
-				pixel.x = px + 0.5f;
-				pixel.y = py + 0.5f;
-		
-				// Calculate vertex to pixel vectors
-				p0 = pixel - v0.position.GetXY();
-				p1 = pixel - v1.position.GetXY();
-				p2 = pixel - v2.position.GetXY();
-		
-				// Barycentric cooridnates (weights)
-				w0 = Vector2::Cross(e1, p1) * invTotalWeight;
-				w1 = Vector2::Cross(e2, p2) * invTotalWeight;
-				w2 = Vector2::Cross(e0, p0) * invTotalWeight;
-		
-				// Check sign equality
+				const Vector2 pixel{ px + 0.5f, py + 0.5f };
+
+				const float w0 = Vector2::Cross(e1, pixel - v1.GetXY()) * invTotalWeight;
+				const float w1 = Vector2::Cross(e2, pixel - v2.GetXY()) * invTotalWeight;
+				const float w2 = Vector2::Cross(e0, pixel - v0.GetXY()) * invTotalWeight;
+
 				if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
-		
-				// Interpolate depth Z value using weights
-				depthZ = 1.0f / (w0 / v0.position.z + w1 / v1.position.z + w2 / v2.position.z);
-		
-				// Frustum culling
+
+				const float depthZ = InterpolateDepth(w0, w1, w2, v0.z, v1.z, v2.z);
+
 				if (depthZ < 0.0f || depthZ > 1.0f) continue;
-		
-				// Calculate pixel index
-				pixelIndex = px + py * m_Width;
-				assert(pixelIndex >= 0 && pixelIndex < m_Width * m_Height && "buffer index out of bounds");
-		
-				// Depth test
-				if (depthZ > m_pDepthBuffer[pixelIndex]) continue;
-		
-				// Interpolate depth W value using weights
-				depthW = 1.0f / (w0 / v0.position.w + w1 / v1.position.w + w2 / v2.position.w);
-		
-				// Construct pixel vertex
-				pixelVertex.position = { static_cast<float>(px), static_cast<float>(py), depthZ, depthW };
-				pixelVertex.color = v0.color * w0 + v1.color * w1 + v2.color * w2;
-				pixelVertex.normal = (v0.normal * w0 + v1.normal * w1 + v2.normal * w2).Normalized();
-				pixelVertex.tangent = (v0.tangent * w0 + v1.tangent * w1 + v2.tangent * w2).Normalized();
-				pixelVertex.viewDirection = (v0.viewDirection * w0 + v1.viewDirection * w1 + v2.viewDirection * w2).Normalized();
-				pixelVertex.uv = (v0.uv / v0.position.w * w0 + v1.uv / v1.position.w * w1 + v2.uv / v2.position.w * w2) * depthW;
-		
-				// Shade test
-				if (!m_pCurrentShader->CanShade(pixelVertex)) continue;
-		
-				// Write depth value
-				m_pDepthBuffer[pixelIndex] = depthZ;
-		
-				if (m_DebugDepthBuffer)
-				{
-					color.r = color.g = color.b = RemapDepth(depthZ, 0.985f, 1.0f);
-				}
-				else
-				{
-					color = m_pCurrentShader->Shade(pixelVertex);
-				}
-		
-				m_pBackBufferPixels[pixelIndex] = SDL_MapRGB(
-					m_pBackBuffer->format,
-					static_cast<uint8_t>(color.r * 255),
-					static_cast<uint8_t>(color.g * 255),
-					static_cast<uint8_t>(color.b * 255)
-				);
+				if (!PassesDepthTest(px, py, depthZ)) continue;
+
+				++samples;
 			}
 		}
+
+		return samples;
 	}
 
 	float Renderer::RemapDepth(float value, float min, float max)
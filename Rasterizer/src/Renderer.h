@@ -1,13 +1,18 @@
 #pragma once
 
 #include <cstdint>
-#include <vector>
 #include <memory>
+#include <span>
+#include <vector>
 
 #include "Camera.h"
 #include "DataTypes.h"
 #include "ColorRGB.h"
+#include "DepthFormat.h"
+#include "Frustum.h"
 #include "Maths.h"
+#include "OcclusionBuffer.h"
+#include "ShadableObject.h"
 
 struct SDL_Window;
 struct SDL_Surface;
@@ -22,6 +27,44 @@ namespace dae
 	class Scene;
 	class Shader;
 
+	struct RenderStatistics
+	{
+		size_t transformedVertices{};
+		// Vertices whose output from an earlier frame was still valid
+		size_t skippedVertices{};
+		double vertexStageMilliseconds{};
+		// Copying the pixel tiles to the back buffer
+		double resolveMilliseconds{};
+		size_t visibleMeshlets{};
+		size_t culledMeshlets{};
+		size_t drawnObjects{};
+		size_t culledObjects{};
+		// Objects inside the frustum but hidden behind occluders
+		size_t occludedObjects{};
+		// Objects tested against the occlusion buffer, the others reused their result of an earlier frame
+		size_t occlusionTests{};
+		// Pixels cleared and drawn again, less than the whole screen for incremental frames
+		size_t redrawnPixels{};
+	};
+
+	// Pixels [left, right) x [top, bottom) of the screen
+	struct ScreenRect
+	{
+		int left{};
+		int top{};
+		int right{};
+		int bottom{};
+
+		bool operator==(const ScreenRect&) const = default;
+	};
+
+	// Handle of an occlusion query, answered by the Render call that follows its issue
+	struct OcclusionQuery
+	{
+		uint32_t frame{};
+		uint32_t index{};
+	};
+
 	class Renderer final
 	{
 	public:
@@ -34,11 +77,38 @@ namespace dae
 		Renderer& operator=(Renderer&&) noexcept = delete;
 
 		void Render(Scene* pScene);
+		// Maps the camera to the viewport and touches only the pixels inside both it and the scissor rect, clears included
+		// Any part of the back buffer can be drawn this way, for split screen views or tiles, the camera aspect ratio has to match the viewport
+		void Render(Scene* pScene, const ScreenRect& viewport, const ScreenRect& scissorRect);
 
 		bool SaveBufferToImage() const;
 		float GetAspectRatio() const;
 
 		void ToggleDebugDepthBuffer();
+		void ToggleOcclusionCulling();
+		// With the camera still, only the parts of the screen where objects appeared, moved or disappeared are drawn again, a static frame is not drawn at all
+		void ToggleIncrementalRendering();
+		// Draws the next frame in full, for changes the renderer cannot see such as shader settings
+		void Invalidate();
+
+		// Reallocates the depth buffer, the next frame is drawn in full. ReversedFloat32 projects with a reversed depth range of the camera
+		void SetDepthFormat(DepthFormat format);
+		DepthFormat GetDepthFormat() const;
+		// Stencil value of the object that covers the pixel, only Unorm24Stencil8 stores it and 0 otherwise
+		uint8_t GetStencil(int x, int y) const;
+
+		// Counters of the last rendered frame
+		const RenderStatistics& GetStatistics() const;
+
+		// Occlusion queries count the pixels of a world space box that pass the depth test, without shading them
+		// Objects are queried with their worldBounds, empty bounds have no samples
+		// Queries issued before a Render are answered against the depth buffer of that frame, so the results lag a frame behind
+		OcclusionQuery IssueOcclusionQuery(const Bounds& worldBounds);
+		// False until the frame that answers the query is rendered, and again once the next frame replaced its answers
+		bool GetOcclusionQueryResult(const OcclusionQuery& query, size_t& visibleSamples) const;
+
+		// Answered right away against the depth buffer and camera of the last rendered frame
+		size_t CountVisibleSamples(const Bounds& worldBounds) const;
 
 	private:
 		SDL_Window* m_pWindow{};
@@ -47,22 +117,246 @@ namespace dae
 		SDL_Surface* m_pBackBuffer{ nullptr };
 		uint32_t* m_pBackBufferPixels{};
 
-		std::unique_ptr<float[]> m_pDepthBuffer{};
+		// Bit position of red, green and blue in the back buffer format, and the bits of its alpha channel
+		int m_BackBufferShifts[3]{};
+		uint32_t m_BackBufferAlphaMask{};
+
+		// Triangles are drawn into tiles of PIXEL_TILE_SIZE squared pixels, each the RGBA8 colors of its pixels followed by their depth
+		// A tile is contiguous and fits in L1, the back buffer only receives the colors when the frame is presented
+		static constexpr int PIXEL_TILE_SIZE{ 8 };
+		static constexpr int PIXEL_TILE_AREA{ PIXEL_TILE_SIZE * PIXEL_TILE_SIZE };
+
+		// Depth values are of DepthEncoding of m_DepthFormat
+		std::unique_ptr<std::byte[]> m_pPixelTiles{};
+		size_t m_PixelTileStride{};
+		int m_PixelTilesX{};
+		DepthFormat m_DepthFormat{ DepthFormat::Float32 };
 
 		int m_Width{};
 		int m_Height{};
 		float m_AspectRatio{};
 
 		bool m_DebugDepthBuffer{};
+		bool m_IsOcclusionCullingEnabled{ true };
+		bool m_IsIncrementalRenderingEnabled{};
+		bool m_IsFrameInvalid{ true };
 
 		Shader* m_pCurrentShader{ nullptr };
+		uint8_t m_CurrentStencil{};
+
+		RenderStatistics m_Statistics{};
+
+		// Frames rendered so far, issued queries are tagged with the frame that answers them
+		uint32_t m_FrameIndex{};
+		std::vector<Bounds> m_PendingQueries{};
+		std::vector<size_t> m_QueryResults{};
+
+		// Camera the depth buffer was last drawn with, in the depth range of m_DepthFormat
+		Matrix m_FrameViewProjection{};
+		// The same camera with its own projection, for culling and screen rects
+		Matrix m_FrameCullingViewProjection{};
+		Vector3 m_FrameCameraOrigin{};
+		// Changes whenever the camera does, cached vertices projected with another version are projected again
+		uint32_t m_CameraVersion{};
+
+		// Indices of the scene objects that are not outside the frustum, and the screen area of each
+		std::vector<uint32_t> m_VisibleObjects{};
+		std::vector<ScreenRect> m_VisibleRects{};
+
+		// What an object looked like when it was last drawn, indexed by the slot of its handle
+		struct DrawnObject
+		{
+			ObjectHandle handle{};
+			const Mesh* pMesh{};
+			const Shader* pShader{};
+			uint32_t worldVersion{};
+			uint32_t frame{};
+			ScreenRect rect{};
+		};
+
+		std::vector<DrawnObject> m_DrawnObjects{};
+		std::vector<uint32_t> m_DrawnSlots{};
+		// Camera version of the last drawn frame
+		uint32_t m_DrawnCameraVersion{};
+
+		// Parts of the screen drawn this frame, pixels outside the scissor rect are not touched
+		std::vector<ScreenRect> m_DirtyRects{};
+		ScreenRect m_ScissorRect{};
+		// Pixels the normalized device coordinates of the camera map to
+		ScreenRect m_Viewport{};
+
+		enum class TileState : uint8_t
+		{
+			// Cleared, but neither the back buffer nor the pixel tiles hold the clear values yet
+			Pending,
+			// The back buffer shows the clear color, the pixel tiles are still to be cleared
+			Resolved,
+			Written
+		};
+
+		// Clears are deferred per tile until the first triangle reaches the tile, the depth of tiles that are not written is the clear value
+		// A clear tile spans whole pixel tiles
+		uint32_t m_ClearColor{};
+		uint32_t m_BackBufferClearColor{};
+		int m_TilesX{};
+		int m_TilesY{};
+		std::vector<TileState> m_TileStates{};
+
+		// Depth of the visible occluders at a fraction of the screen resolution
+		OcclusionBuffer m_OcclusionBuffer;
+
+		// The buffer is drawn again only when its occluders, their world matrices or the camera change
+		struct OccluderState
+		{
+			ObjectHandle handle{};
+			const Mesh* pMesh{};
+			uint32_t worldVersion{};
+
+			bool operator==(const OccluderState&) const = default;
+		};
+
+		std::vector<OccluderState> m_BufferOccluders{};
+		std::vector<OccluderState> m_FrameOccluders{};
+		uint32_t m_OcclusionCameraVersion{};
+		uint32_t m_OcclusionSceneId{ UINT32_MAX };
+		// Changes whenever the buffer is drawn again
+		uint32_t m_OcclusionBufferVersion{};
+
+		// Last occlusion test of an object, indexed by the slot of its handle, valid while neither the object nor the buffer changed
+		struct OcclusionResult
+		{
+			ObjectHandle handle{};
+			uint32_t worldVersion{};
+			uint32_t bufferVersion{};
+			bool isOccluded{};
+		};
+
+		std::vector<OcclusionResult> m_OcclusionResults{};
+
+		// Meshlets of the current object that survived culling, and which of its vertices they already visited
+		std::vector<const Meshlet*> m_VisibleMeshlets{};
+		std::vector<bool> m_IsVertexVisited{};
+
+		enum class VertexState : uint8_t
+		{
+			Outdated,
+			// Attributes and world position are valid, the projection is not
+			WorldSpace,
+			Projected
+		};
+
+		// Vertex stage output of an object, kept across frames while its mesh, world matrix and the camera stay the same
+		struct CachedVertices
+		{
+			ObjectHandle handle{};
+			const Mesh* pMesh{};
+			uint32_t worldVersion{};
+			uint32_t cameraVersion{};
+			// Last frame the object was drawn in, entries of objects that were not are released
+			uint32_t frame{};
+			std::vector<Vertex_Out> vertices{};
+			std::vector<Vector3> worldPositions{};
+			std::vector<VertexState> states{};
+		};
+
+		// Scene whose objects the cache holds
+		uint32_t m_VertexCacheSceneId{};
+		// Indexed by the slot of the object handle, m_CachedSlots lists the entries holding vertices
+		std::vector<CachedVertices> m_VertexCache{};
+		std::vector<uint32_t> m_CachedSlots{};
+		size_t m_CachedVertexCount{};
+		// Shared by the objects the cache has no room for
+		CachedVertices m_UncachedVertices{};
+
+		// Vertex stage output of the object being drawn
+		const Vertex_Out* m_pVerticesOut{};
 
 	private:
-		void VertexTransformationFunction(const Camera& camera, Mesh& mesh) const;
+		// Coarsest level of detail whose error projects to at most LOD_PIXEL_ERROR pixels, with hysteresis on object.lod
+		size_t SelectLOD(const Camera& camera, ShadableObject& object, const Matrix& world) const;
 
-		void RasterizeTriangleStrip(const Mesh& mesh);
-		void RasterizeTriangleList(const Mesh& mesh);
+		// Tiles inside the rect are cleared lazily, pixels of the written tiles it only cuts are cleared right away
+		void ClearRect(const ScreenRect& rect);
+		void ClearTile(int tileX, int tileY);
+		// Copies the colors of the written tiles inside the rect to the back buffer and gives the pending ones their clear color, before it is presented
+		void ResolveRect(const ScreenRect& rect);
+		ScreenRect GetTileRect(int tileX, int tileY) const;
+		// Converts RGBA8 colors of the pixel tiles to the back buffer format
+		void ConvertToBackBuffer(const uint32_t* pColors, uint32_t* pPixels, int count) const;
+		// Fills the color and depth of the pixels inside the rect with the clear values
+		void ClearPixels(const ScreenRect& rect);
+		// Fills depth values [index, index + count) of a pixel tile with the clear value of the format
+		void ClearDepth(std::byte* pTile, int index, int count);
+		// Depth test against the buffer as the tile states define it
+		bool PassesDepthTest(int px, int py, float depth) const;
+		// Whether a projected position lies before the near plane in the depth range of the format
+		bool IsBeforeNearPlane(const Vector4& projected) const;
+
+		// Allocates the pixel tiles for m_DepthFormat, their contents are undefined
+		void AllocatePixelTiles();
+
+		std::byte* GetPixelTile(int px, int py) const
+		{
+			return m_pPixelTiles.get() + (px / PIXEL_TILE_SIZE + py / PIXEL_TILE_SIZE * m_PixelTilesX) * m_PixelTileStride;
+		}
+
+		// Index of the pixel inside its tile
+		static int GetTilePixelIndex(int px, int py)
+		{
+			return px % PIXEL_TILE_SIZE + py % PIXEL_TILE_SIZE * PIXEL_TILE_SIZE;
+		}
+
+		static uint32_t* GetTileColors(std::byte* pTile)
+		{
+			return reinterpret_cast<uint32_t*>(pTile);
+		}
+
+		template<typename Depth>
+		static typename Depth::Value* GetTileDepths(std::byte* pTile)
+		{
+			return reinterpret_cast<typename Depth::Value*>(pTile + PIXEL_TILE_AREA * sizeof(uint32_t));
+		}
+
+		// Fills m_DirtyRects and m_VisibleRects, false when the dirty rects cover too much of the screen to be worth it
+		bool FindDirtyRects(const Scene& scene);
+		// Screen pixels a world space box can cover, the whole screen when it reaches behind the camera
+		ScreenRect GetScreenRect(const Bounds& worldBounds) const;
+
+		// Entry of the object with at least vertexCount vertices, its outdated parts marked so
+		CachedVertices& GetCachedVertices(ObjectHandle handle, const Mesh& mesh, uint32_t worldVersion, size_t vertexCount);
+		// Releases the entries of objects that were not drawn this frame
+		void TrimVertexCache();
+
+		// Vertices [0, vertexCount) are brought up to date, the LOD chain orders the vertices of coarser levels first. Returns how many were transformed
+		size_t VertexTransformationFunction(const Camera& camera, const Mesh& mesh, const Matrix& world, size_t vertexCount, CachedVertices& cache);
+
+		// Draws the occluders of m_VisibleObjects into m_OcclusionBuffer unless it still holds them, and removes the other objects they hide
+		void CullOccludedObjects(const Camera& camera, const Scene& scene);
+
+		// Fills m_VisibleMeshlets with the meshlets of the level that are inside the frustum and not facing away from the camera
+		void CullMeshlets(const Camera& camera, const Frustum& frustum, const Mesh& mesh, const Matrix& world, const MeshLOD& lod);
+		// Brings the vertices of m_VisibleMeshlets only up to date, returns how many were transformed
+		size_t TransformVisibleMeshlets(const Camera& camera, const Mesh& mesh, const Matrix& world, CachedVertices& cache);
+		// Transforms what is outdated of a cached vertex, false when all of it was still valid
+		bool TransformVertex(const Camera& camera, const Mesh& mesh, const Matrix& world, uint32_t index, CachedVertices& cache) const;
+
+		// Draws the level, or the visible meshlets of it, with the vertices of m_pVerticesOut
+		void RasterizeObject(const Mesh& mesh, const MeshLOD& lod);
+		template<typename Index>
+		void RasterizeMesh(const Mesh& mesh, const std::vector<Index>& indices, uint32_t indexOffset, uint32_t indexCount);
+		template<typename Index>
+		void RasterizeTriangleStrip(const Mesh& mesh, std::span<const Index> indices);
+		template<typename Index>
+		void RasterizeTriangleList(std::span<const Index> indices);
 		void RasterizeTriangle(const Vertex_Out& v0, const Vertex_Out& v1, const Vertex_Out& v2);
+		void RasterizeTriangle(const Vertex_Out& v0, const Vertex_Out& v1, const Vertex_Out& v2, const Vector2& e0, const Vector2& e1, const Vector2& e2);
+		template<typename Depth>
+		void RasterizeTriangle(const Vertex_Out& v0, const Vertex_Out& v1, const Vertex_Out& v2, const Vector2& e0, const Vector2& e1, const Vector2& e2);
+
+		// Pixels of the triangle that RasterizeTriangle would not reject by coverage, depth range or depth test
+		size_t CountVisibleSamples(const Vector4& v0, const Vector4& v1, const Vector4& v2) const;
+		// Screen space x and y, z / w and w of a position, as the vertex stage outputs them
+		Vector4 ProjectToScreen(const Matrix& worldViewProjection, const Vector3& position) const;
 
 		float RemapDepth(float value, float min, float max);
 	};
@@ -1,9 +1,24 @@
 #include "Scene.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <execution>
+#include <ranges>
 
 namespace dae
 {
+	namespace
+	{
+		// Scenes created so far
+		std::atomic<uint32_t> sceneCount{};
+	}
+
+	Scene::Scene() :
+		m_Id(++sceneCount)
+	{
+	}
+
 	void Scene::Initialize(float aspectRatio)
 	{
 		m_Camera.Initialize(aspectRatio, 0.001f, 1000.0f);
@@ -19,22 +34,338 @@ namespace dae
 
 	}
 
-	ShadableObject* Scene::AddShadableObject(ShadableObject shadableObject)
+	ObjectHandle Scene::AddShadableObject(ShadableObject shadableObject, const Matrix& localMatrix, ObjectHandle parent)
+	{
+		const uint32_t object = static_cast<uint32_t>(m_ShadableObjects.size());
+
+		uint32_t slot{};
+		if (m_FreeSlots.empty())
+		{
+			slot = static_cast<uint32_t>(m_Slots.size());
+			m_Slots.push_back({ object, 0 });
+		}
+		else
+		{
+			slot = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+			m_Slots[slot] = { object, m_Slots[slot].generation };
+		}
+
+		// Placed right away, a dirty parent takes its new children along when it is updated
+		Matrix worldMatrix = localMatrix;
+		if (IsValid(parent))
+		{
+			m_Slots[slot].parent = parent.slot;
+			m_Slots[slot].nextSibling = m_Slots[parent.slot].firstChild;
+			m_Slots[parent.slot].firstChild = slot;
+
+			worldMatrix = localMatrix * m_WorldMatrices[m_Slots[parent.slot].object];
+		}
+
+		const Bounds worldBounds = shadableObject.pMesh ? shadableObject.pMesh->bounds.Transformed(worldMatrix) : Bounds{};
+
+		m_ShadableObjects.push_back(std::move(shadableObject));
+		m_LocalMatrices.push_back(localMatrix);
+		m_WorldMatrices.push_back(worldMatrix);
+		m_WorldBounds.push_back(worldBounds);
+		m_WorldVersions.push_back(m_TransformVersion + 1);
+		m_ObjectSlots.push_back(slot);
+
+		if (worldBounds.IsEmpty())
+		{
+			m_SpatialItems.push_back(UINT32_MAX);
+			m_UnboundedSlots.push_back(slot);
+		}
+		else
+		{
+			m_SpatialItems.push_back(static_cast<uint32_t>(m_IndexedSlots.size()));
+			m_IndexedSlots.push_back(slot);
+			m_IsIndexOutdated = true;
+		}
+
+		return { slot, m_Slots[slot].generation };
+	}
+
+	void Scene::RemoveShadableObject(ObjectHandle handle)
+	{
+		if (!IsValid(handle)) return;
+
+		const uint32_t object = m_Slots[handle.slot].object;
+
+		// Children stay where they are in the world
+		for (uint32_t child = m_Slots[handle.slot].firstChild; child != UINT32_MAX;)
+		{
+			const uint32_t nextSibling = m_Slots[child].nextSibling;
+
+			m_LocalMatrices[m_Slots[child].object] = m_WorldMatrices[m_Slots[child].object];
+			m_Slots[child].parent = UINT32_MAX;
+			m_Slots[child].nextSibling = UINT32_MAX;
+			MarkDirty(child);
+
+			child = nextSibling;
+		}
+
+		Unlink(handle.slot);
+
+		// The last BVH item takes the place of the removed one, the tree is rebuilt without it
+		const uint32_t item = m_SpatialItems[object];
+		if (item == UINT32_MAX)
+		{
+			std::erase(m_UnboundedSlots, handle.slot);
+		}
+		else
+		{
+			const uint32_t lastSlot = m_IndexedSlots.back();
+			m_IndexedSlots[item] = lastSlot;
+			m_SpatialItems[m_Slots[lastSlot].object] = item;
+			m_IndexedSlots.pop_back();
+			m_IsIndexOutdated = true;
+		}
+
+		// The last object fills the gap, so the arrays stay dense
+		const uint32_t last = static_cast<uint32_t>(m_ShadableObjects.size() - 1);
+		if (object != last)
+		{
+			m_ShadableObjects[object] = std::move(m_ShadableObjects[last]);
+			m_LocalMatrices[object] = m_LocalMatrices[last];
+			m_WorldMatrices[object] = m_WorldMatrices[last];
+			m_WorldBounds[object] = m_WorldBounds[last];
+			m_WorldVersions[object] = m_WorldVersions[last];
+			m_ObjectSlots[object] = m_ObjectSlots[last];
+			m_SpatialItems[object] = m_SpatialItems[last];
+			m_Slots[m_ObjectSlots[object]].object = object;
+		}
+
+		m_ShadableObjects.pop_back();
+		m_LocalMatrices.pop_back();
+		m_WorldMatrices.pop_back();
+		m_WorldBounds.pop_back();
+		m_WorldVersions.pop_back();
+		m_ObjectSlots.pop_back();
+		m_SpatialItems.pop_back();
+
+		// A pending update of the slot is dropped with it
+		Slot& slot = m_Slots[handle.slot];
+		slot = { UINT32_MAX, slot.generation + 1 };
+		m_FreeSlots.push_back(handle.slot);
+	}
+
+	bool Scene::IsValid(ObjectHandle handle) const
+	{
+		return handle.slot < m_Slots.size() && m_Slots[handle.slot].generation == handle.generation;
+	}
+
+	ShadableObject* Scene::GetShadableObject(ObjectHandle handle)
+	{
+		return IsValid(handle) ? &m_ShadableObjects[m_Slots[handle.slot].object] : nullptr;
+	}
+
+	ObjectHandle Scene::GetHandle(uint32_t object) const
+	{
+		const uint32_t slot = m_ObjectSlots[object];
+		return { slot, m_Slots[slot].generation };
+	}
+
+	void Scene::SetParent(ObjectHandle handle, ObjectHandle parent)
+	{
+		assert(IsValid(handle) && "object was removed");
+
+		Unlink(handle.slot);
+
+		if (IsValid(parent))
+		{
+			for (uint32_t ancestor = parent.slot; ancestor != UINT32_MAX; ancestor = m_Slots[ancestor].parent)
+			{
+				assert(ancestor != handle.slot && "an object cannot be its own ancestor");
+			}
+
+			m_Slots[handle.slot].parent = parent.slot;
+			m_Slots[handle.slot].nextSibling = m_Slots[parent.slot].firstChild;
+			m_Slots[parent.slot].firstChild = handle.slot;
+		}
+
+		MarkDirty(handle.slot);
+	}
+
+	void Scene::SetLocalMatrix(ObjectHandle handle, const Matrix& localMatrix)
+	{
+		assert(IsValid(handle) && "object was removed");
+
+		m_LocalMatrices[m_Slots[handle.slot].object] = localMatrix;
+		MarkDirty(handle.slot);
+	}
+
+	const Matrix& Scene::GetLocalMatrix(ObjectHandle handle) const
+	{
+		assert(IsValid(handle) && "object was removed");
+		return m_LocalMatrices[m_Slots[handle.slot].object];
+	}
+
+	const Matrix& Scene::GetWorldMatrix(ObjectHandle handle) const
+	{
+		assert(IsValid(handle) && "object was removed");
+		return m_WorldMatrices[m_Slots[handle.slot].object];
+	}
+
+	const Bounds& Scene::GetWorldBounds(ObjectHandle handle) const
 	{
-		m_ShadableObjects.emplace_back(std::move(shadableObject));
-		return &m_ShadableObjects.back();
+		assert(IsValid(handle) && "object was removed");
+		return m_WorldBounds[m_Slots[handle.slot].object];
 	}
 
-	std::list<ShadableObject>& Scene::GetShadableObjects()
+	void Scene::UpdateTransforms()
+	{
+		++m_TransformVersion;
+
+		// A slot can be queued again after a removal reused it
+		std::sort(m_DirtySlots.begin(), m_DirtySlots.end());
+		m_DirtySlots.erase(std::unique(m_DirtySlots.begin(), m_DirtySlots.end()), m_DirtySlots.end());
+
+		// Walks start at the topmost dirty objects only, the others are part of their subtrees
+		m_DirtyRoots.clear();
+		for (uint32_t slot : m_DirtySlots)
+		{
+			if (!m_Slots[slot].isDirty) continue;
+
+			bool hasDirtyAncestor{};
+			for (uint32_t ancestor = m_Slots[slot].parent; ancestor != UINT32_MAX && !hasDirtyAncestor; ancestor = m_Slots[ancestor].parent)
+			{
+				hasDirtyAncestor = m_Slots[ancestor].isDirty;
+			}
+
+			if (!hasDirtyAncestor) m_DirtyRoots.push_back(slot);
+		}
+
+		for (uint32_t slot : m_DirtySlots)
+		{
+			m_Slots[slot].isDirty = false;
+		}
+		m_DirtySlots.clear();
+
+		if (m_DirtyRoots.empty()) return;
+
+		// The subtrees are disjoint, so every walk writes objects of its own
+		if (m_UpdatedObjects.size() < m_DirtyRoots.size()) m_UpdatedObjects.resize(m_DirtyRoots.size());
+
+		const auto rootRange = std::views::iota(size_t{ 0 }, m_DirtyRoots.size());
+		std::for_each(std::execution::par, rootRange.begin(), rootRange.end(), [&](size_t root)
+		{
+			std::vector<uint32_t>& updatedObjects = m_UpdatedObjects[root];
+			updatedObjects.clear();
+
+			std::vector<uint32_t> stack{ m_DirtyRoots[root] };
+			while (!stack.empty())
+			{
+				const uint32_t slot = stack.back();
+				stack.pop_back();
+
+				const Slot& node = m_Slots[slot];
+				const uint32_t object = node.object;
+
+				m_WorldMatrices[object] = (node.parent == UINT32_MAX)
+					? m_LocalMatrices[object]
+					: m_LocalMatrices[object] * m_WorldMatrices[m_Slots[node.parent].object];
+				m_WorldVersions[object] = m_TransformVersion;
+
+				if (m_SpatialItems[object] != UINT32_MAX)
+				{
+					m_WorldBounds[object] = m_ShadableObjects[object].pMesh->bounds.Transformed(m_WorldMatrices[object]);
+				}
+
+				updatedObjects.push_back(object);
+
+				for (uint32_t child = node.firstChild; child != UINT32_MAX; child = m_Slots[child].nextSibling)
+				{
+					stack.push_back(child);
+				}
+			}
+		});
+
+		for (size_t root = 0; root < m_DirtyRoots.size(); ++root)
+		{
+			for (uint32_t object : m_UpdatedObjects[root])
+			{
+				if (m_SpatialItems[object] != UINT32_MAX) m_MovedItems.push_back(m_SpatialItems[object]);
+			}
+		}
+	}
+
+	uint32_t Scene::GetTransformVersion() const
+	{
+		return m_TransformVersion;
+	}
+
+	void Scene::UpdateSpatialIndex()
+	{
+		if (!m_IsIndexOutdated)
+		{
+			for (uint32_t item : m_MovedItems)
+			{
+				m_BVH.Refit(item, m_WorldBounds[m_Slots[m_IndexedSlots[item]].object]);
+			}
+
+			m_IsIndexOutdated = m_BVH.NeedsRebuild();
+		}
+
+		m_MovedItems.clear();
+
+		if (!m_IsIndexOutdated) return;
+
+		std::vector<Bounds> itemBounds(m_IndexedSlots.size());
+		for (size_t item = 0; item < m_IndexedSlots.size(); ++item)
+		{
+			itemBounds[item] = m_WorldBounds[m_Slots[m_IndexedSlots[item]].object];
+		}
+
+		m_BVH.Build(itemBounds);
+		m_IsIndexOutdated = false;
+	}
+
+	void Scene::QueryFrustum(const Frustum& frustum, std::vector<uint32_t>& objects) const
+	{
+		for (uint32_t slot : m_UnboundedSlots)
+		{
+			objects.push_back(m_Slots[slot].object);
+		}
+
+		m_BVH.QueryFrustum(frustum, [&](uint32_t item) { objects.push_back(m_Slots[m_IndexedSlots[item]].object); });
+	}
+
+	size_t Scene::GetShadableObjectCount() const
+	{
+		return m_ShadableObjects.size();
+	}
+
+	std::span<ShadableObject> Scene::GetShadableObjects()
 	{
 		return m_ShadableObjects;
 	}
 
-	const std::list<ShadableObject>& Scene::GetShadableObjects() const
+	std::span<const ShadableObject> Scene::GetShadableObjects() const
 	{
 		return m_ShadableObjects;
 	}
 
+	std::span<const Matrix> Scene::GetWorldMatrices() const
+	{
+		return m_WorldMatrices;
+	}
+
+	std::span<const Bounds> Scene::GetWorldBounds() const
+	{
+		return m_WorldBounds;
+	}
+
+	std::span<const uint32_t> Scene::GetWorldVersions() const
+	{
+		return m_WorldVersions;
+	}
+
+	uint32_t Scene::GetId() const
+	{
+		return m_Id;
+	}
+
 	Camera& Scene::GetCamera()
 	{
 		return m_Camera;
@@ -45,4 +376,25 @@ namespace dae
 		return m_Camera;
 	}
 
+	void Scene::MarkDirty(uint32_t slot)
+	{
+		if (m_Slots[slot].isDirty) return;
+
+		m_Slots[slot].isDirty = true;
+		m_DirtySlots.push_back(slot);
+	}
+
+	void Scene::Unlink(uint32_t slot)
+	{
+		const uint32_t parent = m_Slots[slot].parent;
+		if (parent == UINT32_MAX) return;
+
+		uint32_t* pLink = &m_Slots[parent].firstChild;
+		while (*pLink != slot) pLink = &m_Slots[*pLink].nextSibling;
+
+		*pLink = m_Slots[slot].nextSibling;
+		m_Slots[slot].parent = UINT32_MAX;
+		m_Slots[slot].nextSibling = UINT32_MAX;
+	}
+
 }
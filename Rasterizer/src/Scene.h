@@ -1,7 +1,9 @@
 #pragma once
 
-#include <list>
+#include <span>
+#include <vector>
 
+#include "BVH.h"
 #include "Camera.h"
 #include "Timer.h"
 #include "ShadableObject.h"
@@ -13,7 +15,7 @@ namespace dae
 	class Scene
 	{
 	public:
-		Scene() = default;
+		Scene();
 		virtual ~Scene() = default;
 
 		Scene(const Scene&)				= delete;
@@ -25,16 +27,107 @@ namespace dae
 		virtual void Update(Timer* pTimer);
 		virtual void OnEvent(const SDL_Event& e);
 
-		ShadableObject* AddShadableObject(ShadableObject shadableObject);
+		// Objects are placed relative to their parent (world = local * parent world), without a valid parent they are roots
+		ObjectHandle AddShadableObject(ShadableObject shadableObject, const Matrix& localMatrix = {}, ObjectHandle parent = {});
+		// The last object takes the place of the removed one, so indices into the object arrays change
+		// Children of the removed object become roots and keep their place in the world
+		void RemoveShadableObject(ObjectHandle handle);
 
-		std::list<ShadableObject>& GetShadableObjects();
-		const std::list<ShadableObject>& GetShadableObjects() const;
+		// False once the object was removed
+		bool IsValid(ObjectHandle handle) const;
+		// nullptr for invalid handles, the pointer is only stable until objects are added or removed
+		ShadableObject* GetShadableObject(ObjectHandle handle);
+		// Handle of the object at an index of the object arrays
+		ObjectHandle GetHandle(uint32_t object) const;
+
+		// An invalid parent makes the object a root, its local matrix is kept
+		void SetParent(ObjectHandle handle, ObjectHandle parent);
+
+		// Marks the object dirty, its world matrix and those below it follow at the next UpdateTransforms
+		void SetLocalMatrix(ObjectHandle handle, const Matrix& localMatrix);
+		const Matrix& GetLocalMatrix(ObjectHandle handle) const;
+		// As of the last UpdateTransforms
+		const Matrix& GetWorldMatrix(ObjectHandle handle) const;
+		const Bounds& GetWorldBounds(ObjectHandle handle) const;
+
+		// Recomputes the world matrices and bounds of the dirty subtrees, in parallel, and queues the moved objects for the spatial index
+		// Objects outside a dirty subtree are not touched
+		void UpdateTransforms();
+		// Number of UpdateTransforms calls so far
+		uint32_t GetTransformVersion() const;
+
+		// Builds the spatial index after objects were added or moves loosened it too much, otherwise refits the moved objects
+		// Moves only count once UpdateTransforms has applied them
+		void UpdateSpatialIndex();
+
+		// Appends the index of every object whose bounds are not outside the frustum, objects without bounds are always appended
+		// Walks the spatial index, so the cost follows the visible part of the scene
+		void QueryFrustum(const Frustum& frustum, std::vector<uint32_t>& objects) const;
+
+		size_t GetShadableObjectCount() const;
+
+		// Every object in storage order, index i of each array belongs to the same object
+		std::span<ShadableObject> GetShadableObjects();
+		std::span<const ShadableObject> GetShadableObjects() const;
+		std::span<const Matrix> GetWorldMatrices() const;
+		// pMesh->bounds in world space, kept up to date by UpdateTransforms
+		std::span<const Bounds> GetWorldBounds() const;
+		// Transform version in which the world matrix of each object last changed, an object changed since version v when its entry is above v
+		std::span<const uint32_t> GetWorldVersions() const;
+
+		// Unique among the scenes created so far, even for a scene at the address of a destroyed one
+		uint32_t GetId() const;
 
 		Camera& GetCamera();
 		const Camera& GetCamera() const;
 
 	private:
-		std::list<ShadableObject> m_ShadableObjects;
+		uint32_t m_Id{};
+
+		// Objects are stored densely, the hot data the renderer streams through in arrays of its own
+		std::vector<ShadableObject> m_ShadableObjects{};
+		std::vector<Matrix> m_LocalMatrices{};
+		std::vector<Matrix> m_WorldMatrices{};
+		std::vector<Bounds> m_WorldBounds{};
+		std::vector<uint32_t> m_WorldVersions{};
+		// Slot of every object, and its BVH item or UINT32_MAX when it is not indexed
+		std::vector<uint32_t> m_ObjectSlots{};
+		std::vector<uint32_t> m_SpatialItems{};
+
+		// Handles name a slot, which finds the object while the generation matches
+		// The hierarchy links slots as well, so it is not affected when objects move in storage
+		struct Slot
+		{
+			uint32_t object;
+			uint32_t generation;
+			uint32_t parent{ UINT32_MAX };
+			uint32_t firstChild{ UINT32_MAX };
+			uint32_t nextSibling{ UINT32_MAX };
+			bool isDirty{};
+		};
+
+		std::vector<Slot> m_Slots{};
+		std::vector<uint32_t> m_FreeSlots{};
+
+		// Slots whose local matrix or parent changed since the last UpdateTransforms, and the topmost of them
+		std::vector<uint32_t> m_DirtySlots{};
+		std::vector<uint32_t> m_DirtyRoots{};
+		// Objects every subtree walk of UpdateTransforms changed
+		std::vector<std::vector<uint32_t>> m_UpdatedObjects{};
+		uint32_t m_TransformVersion{};
+
 		Camera m_Camera;
+
+		// BVH items are slots of the indexed objects, slots stay put when objects move in storage
+		BVH m_BVH{};
+		std::vector<uint32_t> m_IndexedSlots{};
+		std::vector<uint32_t> m_UnboundedSlots{};
+		std::vector<uint32_t> m_MovedItems{};
+		bool m_IsIndexOutdated{};
+
+	private:
+		void MarkDirty(uint32_t slot);
+		// Removes the slot from the children of its parent
+		void Unlink(uint32_t slot);
 	};
 }
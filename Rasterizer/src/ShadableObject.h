@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 
 #include "DataTypes.h"
@@ -7,9 +8,29 @@
 
 namespace dae
 {
+	// Instance of a mesh, any number of objects can share the same geometry
+	// The scene keeps the world matrix and bounds of every object in arrays of their own
 	struct ShadableObject
 	{
-		Mesh mesh;
+		std::shared_ptr<const Mesh> pMesh;
 		std::shared_ptr<Shader> pShader;
+
+		// Index into pMesh->lods drawn last frame, the renderer only switches away from it past a margin
+		size_t lod{};
+
+		// Drawn into the occlusion buffer of the renderer, so objects behind it are skipped. Best suited to large, simple meshes
+		bool isOccluder{};
+
+		// Written to the depth buffer with the depth of the object, when its format has a stencil
+		uint8_t stencil{};
+	};
+
+	// Names an object of a scene, a handle to a removed object stays invalid even when its slot is reused
+	struct ObjectHandle
+	{
+		uint32_t slot{ UINT32_MAX };
+		uint32_t generation{};
+
+		bool operator==(const ObjectHandle&) const = default;
 	};
 }
@@ -5,11 +5,15 @@
 
 //Standard includes
 #include <iostream>
+#include <string>
 
 //Project includes
 #include "Timer.h"
 #include "Renderer.h"
 
+//Benchmark includes
+#include "Benchmarks.h"
+
 //Scene includes
 #include "LambertShader.h"
 #include "ReferenceScene.h"
@@ -24,13 +28,17 @@ void ShutDown(SDL_Window* pWindow)
 
 int main(int argc, char* args[])
 {
-	//Unreferenced parameters
-	(void)argc;
-	(void)args;
-
 	//Create window + surfaces
 	SDL_Init(SDL_INIT_VIDEO);
 
+	//Run the benchmarks instead of the interactive scene
+	if (argc > 1 && std::string{ args[1] } == "--benchmark")
+	{
+		Benchmarks::RunAll();
+		SDL_Quit();
+		return 0;
+	}
+
 	const uint32_t width = 640;
 	const uint32_t height = 480;
 
@@ -84,10 +92,24 @@ int main(int argc, char* args[])
 
 					case SDL_SCANCODE_F6:
 						LambertShader::ToggleNormalMapping();
+						pRenderer->Invalidate();
 						break;
 
 					case SDL_SCANCODE_F7:
 						LambertShader::CycleMode();
+						pRenderer->Invalidate();
+						break;
+
+					case SDL_SCANCODE_F8:
+						pRenderer->ToggleOcclusionCulling();
+						break;
+
+					case SDL_SCANCODE_F9:
+						pRenderer->ToggleIncrementalRendering();
+						break;
+
+					case SDL_SCANCODE_F10:
+						pRenderer->SetDepthFormat(static_cast<DepthFormat>((static_cast<int>(pRenderer->GetDepthFormat()) + 1) % 4));
 						break;
 				}
 				break;
@@ -1,5 +1,17 @@
 #include "gtest/gtest.h"
+
+#include <algorithm>
+#include <array>
 #include "Maths.h"
+#include "Utils.h"
+#include "MeshOptimizer.h"
+#include "MeshCache.h"
+#include "Quantization.h"
+#include "MeshCodec.h"
+#include "Frustum.h"
+#include "BVH.h"
+#include "OcclusionBuffer.h"
+#include "DepthFormat.h"
 
 
 namespace dae
@@ -9,4 +21,490 @@ namespace dae
 		EXPECT_TRUE(true);
 	}
 
+	TEST(ParseOBJ, Quad) {
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+
+		ASSERT_TRUE(Utils::ParseOBJ("../Rasterizer/Resources/quad.obj", vertices, indices));
+		EXPECT_EQ(indices.size(), 6);
+
+		// Corners with the same position, uv and normal are welded
+		EXPECT_EQ(vertices.size(), 4);
+		EXPECT_EQ(indices[0], indices[3]);
+
+		// Winding and z axis are flipped: the first face "2 3 1" becomes "2 1 3"
+		EXPECT_EQ(indices[1], 2);
+		EXPECT_EQ(vertices[indices[0]].normal, Vector3(0.0f, 0.0f, -1.0f));
+	}
+
+	TEST(ParseOBJ, MissingFile) {
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+
+		EXPECT_FALSE(Utils::ParseOBJ("does_not_exist.obj", vertices, indices));
+	}
+
+	TEST(ParseOBJ, Chunks) {
+		std::vector<Vertex> vertices, chunkedVertices;
+		std::vector<uint32_t> indices, chunkedIndices;
+
+		// The split is invisible in the result, whatever the number of chunks
+		ASSERT_TRUE(Utils::ParseOBJ("../Rasterizer/Resources/vehicle.obj", vertices, indices, true, 1));
+		ASSERT_TRUE(Utils::ParseOBJ("../Rasterizer/Resources/vehicle.obj", chunkedVertices, chunkedIndices, true, 7));
+
+		EXPECT_EQ(indices, chunkedIndices);
+		ASSERT_EQ(vertices.size(), chunkedVertices.size());
+		for (size_t i = 0; i < vertices.size(); ++i)
+		{
+			EXPECT_EQ(vertices[i].position, chunkedVertices[i].position);
+			EXPECT_EQ(vertices[i].uv, chunkedVertices[i].uv);
+			EXPECT_EQ(vertices[i].normal, chunkedVertices[i].normal);
+		}
+	}
+
+	TEST(MeshOptimizer, VertexCache) {
+		// 32x32 grid of quads, triangles ordered column-major so rows are re-fetched
+		const uint32_t size{ 33 };
+		std::vector<Vertex> vertices(size * size);
+		std::vector<uint32_t> indices;
+
+		for (uint32_t x = 0; x + 1 < size; ++x)
+		{
+			for (uint32_t y = 0; y + 1 < size; ++y)
+			{
+				const uint32_t i = x + y * size;
+				indices.insert(indices.end(), { i, i + 1, i + size, i + 1, i + size + 1, i + size });
+			}
+		}
+
+		for (size_t i = 0; i < vertices.size(); ++i) vertices[i].position.x = static_cast<float>(i);
+
+		const std::vector<uint32_t> original = indices;
+		const float acmrBefore = MeshOptimizer::CalculateACMR(indices, vertices.size());
+
+		MeshOptimizer::OptimizeVertexCache(indices, vertices.size());
+		EXPECT_LT(MeshOptimizer::CalculateACMR(indices, vertices.size()), acmrBefore);
+
+		std::vector<Vertex> reordered = vertices;
+		std::vector<uint32_t> remapped = indices;
+		MeshOptimizer::OptimizeVertexFetch(reordered, remapped);
+
+		// Same triangles, referencing the same vertex data
+		ASSERT_EQ(remapped.size(), original.size());
+		for (size_t i = 0; i < remapped.size(); ++i)
+		{
+			EXPECT_EQ(reordered[remapped[i]].position, vertices[indices[i]].position);
+		}
+		EXPECT_EQ(remapped[0], 0);
+	}
+
+	TEST(MeshCache, RoundTrip) {
+		const std::string source{ "../Rasterizer/Resources/quad.obj" };
+		const std::string cache{ "quad_test.mesh" };
+
+		Mesh mesh{};
+		ASSERT_TRUE(Utils::ParseOBJ(source, mesh.vertices, mesh.indices));
+		mesh.primitiveTopology = PrimitiveTopology::TriangleList;
+		ASSERT_TRUE(MeshCache::Write(cache, source, mesh));
+
+		Mesh loaded{};
+		ASSERT_TRUE(MeshCache::Read(cache, source, loaded));
+		EXPECT_EQ(loaded.indices, mesh.indices);
+		ASSERT_EQ(loaded.vertices.size(), mesh.vertices.size());
+		EXPECT_EQ(loaded.vertices[1].uv, mesh.vertices[1].uv);
+		EXPECT_EQ(loaded.primitiveTopology, PrimitiveTopology::TriangleList);
+
+		// Stamped with another source, the cache is stale
+		EXPECT_FALSE(MeshCache::Read(cache, "../Rasterizer/Resources/tuktuk.obj", loaded));
+
+		std::remove(cache.c_str());
+	}
+
+	TEST(Quantization, Mesh) {
+		Mesh mesh{};
+		ASSERT_TRUE(Utils::ParseOBJ("../Rasterizer/Resources/vehicle.obj", mesh.vertices, mesh.indices));
+
+		const Mesh original = mesh;
+		Quantization::QuantizeMesh(mesh);
+
+		EXPECT_TRUE(mesh.vertices.empty());
+		EXPECT_TRUE(mesh.indices.empty());
+		ASSERT_EQ(mesh.quantizedVertices.size(), original.vertices.size());
+		ASSERT_EQ(mesh.indices16.size(), original.indices.size());
+		EXPECT_LT(Quantization::GetGeometrySize(mesh) * 2, Quantization::GetGeometrySize(original));
+
+		for (size_t i = 0; i < original.vertices.size(); i += 97)
+		{
+			const Vertex decoded = Quantization::DecodeVertex(mesh.quantizedVertices[i], mesh.quantizationBox);
+			const Vertex& expected = original.vertices[i];
+
+			EXPECT_LT((decoded.position - expected.position).Magnitude(), 0.01f);
+			EXPECT_LT((decoded.normal - expected.normal).Magnitude(), 0.001f);
+			EXPECT_LT((decoded.uv - expected.uv).Magnitude(), 0.001f);
+		}
+
+		EXPECT_EQ(Quantization::HalfToFloat(Quantization::FloatToHalf(0.5f)), 0.5f);
+	}
+
+	TEST(MeshCodec, RoundTrip) {
+		std::vector<uint32_t> indices;
+		for (uint32_t i = 0; i < 10000; ++i) indices.push_back((i * 7919u) % 5003u + (i % 3 == 0 ? UINT32_MAX - i : 0u));
+
+		const std::vector<uint8_t> encodedIndices = MeshCodec::EncodeIndices(indices);
+		std::vector<uint32_t> decodedIndices;
+		ASSERT_TRUE(MeshCodec::DecodeIndices(encodedIndices.data(), encodedIndices.size(), decodedIndices));
+		EXPECT_EQ(decodedIndices, indices);
+
+		// Truncated data is rejected
+		EXPECT_FALSE(MeshCodec::DecodeIndices(encodedIndices.data(), encodedIndices.size() / 2, decodedIndices));
+
+		Mesh mesh{};
+		ASSERT_TRUE(Utils::ParseOBJ("../Rasterizer/Resources/tuktuk.obj", mesh.vertices, mesh.indices));
+		Quantization::QuantizeMesh(mesh);
+
+		const std::vector<uint8_t> encodedVertices = MeshCodec::EncodeVertices(mesh.quantizedVertices);
+		EXPECT_LT(encodedVertices.size(), mesh.quantizedVertices.size() * sizeof(QuantizedVertex));
+
+		std::vector<QuantizedVertex> decodedVertices;
+		ASSERT_TRUE(MeshCodec::DecodeVertices(encodedVertices.data(), encodedVertices.size(), decodedVertices));
+		ASSERT_EQ(decodedVertices.size(), mesh.quantizedVertices.size());
+		EXPECT_EQ(std::memcmp(decodedVertices.data(), mesh.quantizedVertices.data(), decodedVertices.size() * sizeof(QuantizedVertex)), 0);
+	}
+
+	TEST(MeshOptimizer, Simplify) {
+		// Flat 8x8 grid of quads, every interior vertex can go without changing the surface
+		const int size{ 8 };
+
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+
+		for (int y = 0; y <= size; ++y)
+		{
+			for (int x = 0; x <= size; ++x)
+			{
+				Vertex vertex{};
+				vertex.position = { static_cast<float>(x), static_cast<float>(y), 0.0f };
+				vertices.push_back(vertex);
+			}
+		}
+
+		for (int y = 0; y < size; ++y)
+		{
+			for (int x = 0; x < size; ++x)
+			{
+				const uint32_t i = y * (size + 1) + x;
+				indices.insert(indices.end(), { i, i + size + 1, i + 1, i + 1, i + size + 1, i + size + 2 });
+			}
+		}
+
+		float error{ -1.0f };
+		const std::vector<uint32_t> simplified = MeshOptimizer::Simplify(vertices, indices, indices.size() / 4, 0.01f, error);
+
+		EXPECT_LE(simplified.size(), indices.size() / 4);
+		EXPECT_NEAR(error, 0.0f, 1e-3f);
+
+		// The border stays in place and no triangle flips, so the signed area still covers the grid exactly
+		float area{};
+		for (size_t i = 0; i < simplified.size(); i += 3)
+		{
+			const Vector3& p0 = vertices[simplified[i]].position;
+			const Vector3& p1 = vertices[simplified[i + 1]].position;
+			const Vector3& p2 = vertices[simplified[i + 2]].position;
+
+			const float signedArea = Vector3::Cross(p1 - p0, p2 - p0).z * 0.5f;
+			EXPECT_LT(signedArea, 0.0f);
+			area -= signedArea;
+		}
+
+		EXPECT_NEAR(area, static_cast<float>(size * size), 1e-3f);
+	}
+
+	TEST(MeshOptimizer, BuildMeshlets) {
+		// Flat 16x16 grid of quads facing -z, more triangles than a single meshlet holds
+		const int size{ 16 };
+
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+
+		for (int y = 0; y <= size; ++y)
+		{
+			for (int x = 0; x <= size; ++x)
+			{
+				Vertex vertex{};
+				vertex.position = { static_cast<float>(x), static_cast<float>(y), 0.0f };
+				vertex.normal = { 0.0f, 0.0f, -1.0f };
+				vertices.push_back(vertex);
+			}
+		}
+
+		for (int y = 0; y < size; ++y)
+		{
+			for (int x = 0; x < size; ++x)
+			{
+				const uint32_t i = y * (size + 1) + x;
+				indices.insert(indices.end(), { i, i + size + 1, i + 1, i + 1, i + size + 1, i + size + 2 });
+			}
+		}
+
+		const auto toTriangles = [](const std::vector<uint32_t>& indices)
+		{
+			std::vector<std::array<uint32_t, 3>> triangles;
+			for (size_t i = 0; i < indices.size(); i += 3) triangles.push_back({ indices[i], indices[i + 1], indices[i + 2] });
+			std::sort(triangles.begin(), triangles.end());
+			return triangles;
+		};
+
+		const auto trianglesBefore = toTriangles(indices);
+		const std::vector<Meshlet> meshlets = MeshOptimizer::BuildMeshlets(vertices, indices);
+		ASSERT_GT(meshlets.size(), 1);
+
+		// Triangles are only reordered, each keeps its winding
+		EXPECT_EQ(toTriangles(indices), trianglesBefore);
+
+		// Consecutive ranges covering every triangle, within the limits, bounded by their sphere and all facing along their cone
+		uint32_t nextIndex{};
+		for (const Meshlet& meshlet : meshlets)
+		{
+			EXPECT_EQ(meshlet.indexOffset, nextIndex);
+			EXPECT_LE(meshlet.indexCount / 3, MeshOptimizer::MESHLET_MAX_TRIANGLES);
+			nextIndex += meshlet.indexCount;
+
+			std::vector<uint32_t> unique(indices.begin() + meshlet.indexOffset, indices.begin() + meshlet.indexOffset + meshlet.indexCount);
+			std::sort(unique.begin(), unique.end());
+			unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+			EXPECT_LE(unique.size(), MeshOptimizer::MESHLET_MAX_VERTICES);
+
+			for (uint32_t index : unique)
+			{
+				EXPECT_LE((vertices[index].position - meshlet.center).Magnitude(), meshlet.radius + 1e-4f);
+			}
+
+			EXPECT_NEAR(meshlet.coneAxis.z, -1.0f, 1e-4f);
+			EXPECT_NEAR(meshlet.coneCutoff, 0.0f, 1e-3f);
+		}
+
+		EXPECT_EQ(nextIndex, indices.size());
+	}
+
+	TEST(MeshOptimizer, Stripify) {
+		// Two quads sharing an edge and a separate triangle
+		const std::vector<uint32_t> indices{ 0, 1, 2, 2, 1, 3, 2, 3, 4, 4, 3, 5, 6, 7, 8 };
+
+		const auto addTriangle = [](std::vector<std::array<uint32_t, 3>>& triangles, uint32_t a, uint32_t b, uint32_t c)
+		{
+			std::array<uint32_t, 3> triangle{ a, b, c };
+			std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+			triangles.push_back(triangle);
+		};
+
+		std::vector<std::array<uint32_t, 3>> expected;
+		for (size_t i = 0; i < indices.size(); i += 3) addTriangle(expected, indices[i], indices[i + 1], indices[i + 2]);
+		std::sort(expected.begin(), expected.end());
+
+		for (bool primitiveRestart : { false, true })
+		{
+			SCOPED_TRACE(primitiveRestart);
+			const std::vector<uint32_t> strip = MeshOptimizer::Stripify(indices, primitiveRestart);
+
+			// Every triangle of the list appears once in the strip with the same winding, degenerates excepted
+			// A restart index starts the next strip with even winding again
+			std::vector<std::array<uint32_t, 3>> actual;
+			size_t degenerates{}, stripLength{};
+
+			for (size_t i = 0; i < strip.size(); ++i)
+			{
+				if (strip[i] == PRIMITIVE_RESTART_INDEX<uint32_t>)
+				{
+					stripLength = 0;
+					continue;
+				}
+
+				if (++stripLength < 3) continue;
+
+				const uint32_t a = strip[i - 2], b = strip[i - 1], c = strip[i];
+				if (a == b || b == c || a == c)
+				{
+					++degenerates;
+					continue;
+				}
+
+				if (stripLength % 2 != 0) addTriangle(actual, a, b, c);
+				else addTriangle(actual, b, a, c);
+			}
+
+			std::sort(actual.begin(), actual.end());
+			EXPECT_EQ(actual, expected);
+			EXPECT_LT(strip.size(), indices.size());
+			if (primitiveRestart)
+			{
+				EXPECT_EQ(degenerates, 0);
+			}
+		}
+	}
+
+	TEST(Frustum, Bounds) {
+		// Camera at the origin looking down +z, 90 degrees vertical field of view
+		const Frustum frustum = Frustum::FromMatrix(Matrix::CreatePerspectiveFovLH(1.0f, 1.0f, 1.0f, 100.0f));
+
+		std::vector<Vertex> vertices(2);
+		vertices[0].position = { -1.0f, -1.0f, -1.0f };
+		vertices[1].position = { 1.0f, 1.0f, 1.0f };
+
+		const Bounds bounds = Bounds::FromVertices(vertices);
+		EXPECT_NEAR(bounds.radius, std::sqrt(3.0f), 1e-5f);
+
+		const auto isOutside = [&](const Matrix& world)
+		{
+			const Bounds worldBounds = bounds.Transformed(world);
+			return frustum.IsSphereOutside(worldBounds.center, worldBounds.radius) || frustum.IsBoxOutside(worldBounds.min, worldBounds.max);
+		};
+
+		EXPECT_FALSE(isOutside(Matrix::CreateTranslation(0.0f, 0.0f, 10.0f)));
+		EXPECT_FALSE(isOutside(Matrix::CreateTranslation(10.5f, 0.0f, 10.0f)));
+		EXPECT_TRUE(isOutside(Matrix::CreateTranslation(0.0f, 0.0f, -10.0f)));
+		EXPECT_TRUE(isOutside(Matrix::CreateTranslation(15.0f, 0.0f, 10.0f)));
+		EXPECT_TRUE(isOutside(Matrix::CreateTranslation(0.0f, 0.0f, 110.0f)));
+
+		// Scaling grows the box and the sphere with it
+		const Bounds scaled = bounds.Transformed(Matrix::CreateScale(2.0f, 2.0f, 2.0f) * Matrix::CreateTranslation(0.0f, 0.0f, 10.0f));
+		EXPECT_EQ(scaled.min, Vector3(-2.0f, -2.0f, 8.0f));
+		EXPECT_NEAR(scaled.radius, 2.0f * std::sqrt(3.0f), 1e-5f);
+	}
+
+	TEST(BVH, QueryFrustum) {
+		const Frustum frustum = Frustum::FromMatrix(Matrix::CreatePerspectiveFovLH(1.0f, 1.0f, 1.0f, 100.0f));
+
+		// Unit boxes scattered around the camera, enough for the parallel build phase
+		std::vector<Bounds> items(20000);
+		uint32_t seed{ 1 };
+		const auto random = [&]() { seed = seed * 1664525u + 1013904223u; return (seed >> 8) / static_cast<float>(1 << 24) * 200.0f - 100.0f; };
+
+		for (Bounds& item : items)
+		{
+			item.center = { random(), random(), random() };
+			item.min = item.center - Vector3{ 0.5f, 0.5f, 0.5f };
+			item.max = item.center + Vector3{ 0.5f, 0.5f, 0.5f };
+		}
+
+		BVH bvh{};
+		bvh.Build(items);
+		EXPECT_EQ(bvh.GetItemCount(), items.size());
+
+		// Same items as testing every box on its own
+		const auto expectBruteForce = [&]()
+		{
+			std::vector<uint32_t> expected, actual;
+			for (uint32_t item = 0; item < items.size(); ++item)
+			{
+				if (!frustum.IsBoxOutside(items[item].min, items[item].max)) expected.push_back(item);
+			}
+
+			bvh.QueryFrustum(frustum, [&](uint32_t item) { actual.push_back(item); });
+			std::sort(actual.begin(), actual.end());
+
+			EXPECT_FALSE(expected.empty());
+			EXPECT_EQ(actual, expected);
+		};
+
+		expectBruteForce();
+
+		// Moved items are found at their new place after a refit
+		for (uint32_t item = 0; item < items.size(); item += 7)
+		{
+			items[item].min.z += 150.0f;
+			items[item].max.z += 150.0f;
+			bvh.Refit(item, items[item]);
+		}
+
+		expectBruteForce();
+		EXPECT_TRUE(bvh.NeedsRebuild());
+	}
+
+	TEST(OcclusionBuffer, Quad) {
+		const Matrix viewProjection = Matrix::CreatePerspectiveFovLH(1.0f, 1.0f, 1.0f, 100.0f);
+
+		// 4x4 wall facing the camera at z = 10, a strip of two triangles
+		Mesh wall{};
+		wall.vertices.resize(4);
+		wall.vertices[0].position = { -2.0f, -2.0f, 10.0f };
+		wall.vertices[1].position = { -2.0f, 2.0f, 10.0f };
+		wall.vertices[2].position = { 2.0f, -2.0f, 10.0f };
+		wall.vertices[3].position = { 2.0f, 2.0f, 10.0f };
+		wall.indices = { 0, 1, 2, 3 };
+
+		OcclusionBuffer buffer{ 64, 64 };
+		buffer.RasterizeOccluder(wall, viewProjection);
+		buffer.Finalize();
+
+		EXPECT_LT(buffer.GetDepth(32, 32), 1.0f);
+		EXPECT_EQ(buffer.GetDepth(2, 2), FLT_MAX);
+
+		// Only boxes completely behind the wall are occluded
+		EXPECT_TRUE(buffer.IsBoxOccluded({ -1.0f, -1.0f, 15.0f }, { 1.0f, 1.0f, 17.0f }, viewProjection));
+		EXPECT_FALSE(buffer.IsBoxOccluded({ -1.0f, -1.0f, 5.0f }, { 1.0f, 1.0f, 7.0f }, viewProjection));
+		EXPECT_FALSE(buffer.IsBoxOccluded({ -1.0f, -1.0f, 9.0f }, { 1.0f, 1.0f, 17.0f }, viewProjection));
+		EXPECT_FALSE(buffer.IsBoxOccluded({ 1.5f, -1.0f, 15.0f }, { 3.5f, 1.0f, 17.0f }, viewProjection));
+		EXPECT_FALSE(buffer.IsBoxOccluded({ -1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f, 17.0f }, viewProjection));
+	}
+
+	TEST(DepthFormat, ReversedZ) {
+		const Matrix projection = Matrix::CreatePerspectiveFovLHReversedZ(1.0f, 1.0f, 1.0f, 100.0f);
+
+		const Vector4 nearPoint = projection.TransformPoint(0.0f, 0.0f, 1.0f, 1.0f);
+		const Vector4 farPoint = projection.TransformPoint(0.0f, 0.0f, 100.0f, 1.0f);
+		const Vector4 midPoint = projection.TransformPoint(0.0f, 0.0f, 10.0f, 1.0f);
+
+		EXPECT_NEAR(nearPoint.z / nearPoint.w, 1.0f, 1e-6f);
+		EXPECT_NEAR(farPoint.z / farPoint.w, 0.0f, 1e-6f);
+		EXPECT_GT(midPoint.z / midPoint.w, farPoint.z / farPoint.w);
+
+		// Closer depth passes, equal depth passes as well
+		EXPECT_TRUE(DepthEncoding::ReversedFloat32::Passes(0.5f, DepthEncoding::ReversedFloat32::CLEAR));
+		EXPECT_FALSE(DepthEncoding::ReversedFloat32::Passes(0.2f, 0.5f));
+		EXPECT_TRUE(DepthEncoding::ReversedFloat32::Passes(0.5f, 0.5f));
+	}
+
+	TEST(DepthFormat, InterpolatedDepth) {
+		const Matrix projection = Matrix::CreatePerspectiveFovLHReversedZ(1.0f, 1.0f, 1.0f, 100.0f);
+
+		// Edge from view depth 1 to 100, the screen-space midpoint is the point at 1 / 101 of the way along it
+		const Vector3 start{ -1.0f, 0.0f, 1.0f };
+		const Vector3 end{ 50.0f, 0.0f, 100.0f };
+		const Vector3 middle = start + (end - start) * (1.0f / 101.0f);
+
+		const Vector4 projectedStart = projection.TransformPoint(start.x, start.y, start.z, 1.0f);
+		const Vector4 projectedEnd = projection.TransformPoint(end.x, end.y, end.z, 1.0f);
+		const Vector4 projectedMiddle = projection.TransformPoint(middle.x, middle.y, middle.z, 1.0f);
+
+		const float startX = projectedStart.x / projectedStart.w;
+		const float endX = projectedEnd.x / projectedEnd.w;
+		ASSERT_NEAR(projectedMiddle.x / projectedMiddle.w, 0.5f * (startX + endX), 1e-5f);
+
+		const float startZ = projectedStart.z / projectedStart.w;
+		const float endZ = projectedEnd.z / projectedEnd.w;
+		EXPECT_NEAR(InterpolateDepth(0.5f, 0.5f, 0.0f, startZ, endZ, startZ), projectedMiddle.z / projectedMiddle.w, 1e-6f);
+	}
+
+	TEST(DepthFormat, Encoding) {
+		using DepthEncoding::Unorm16;
+		using DepthEncoding::Unorm24Stencil8;
+
+		EXPECT_EQ(Unorm16::Encode(0.0f), 0);
+		EXPECT_EQ(Unorm16::Encode(1.0f), UINT16_MAX);
+		EXPECT_NEAR(Unorm16::Decode(Unorm16::Encode(0.3f)), 0.3f, 1.0f / UINT16_MAX);
+		EXPECT_TRUE(Unorm16::Passes(Unorm16::Encode(1.0f), Unorm16::CLEAR));
+		EXPECT_FALSE(Unorm16::Passes(Unorm16::Encode(0.6f), Unorm16::Encode(0.5f)));
+
+		const Unorm24Stencil8::Value value = Unorm24Stencil8::Encode(0.3f, 7);
+		EXPECT_NEAR(Unorm24Stencil8::Decode(value), 0.3f, 1.0f / Unorm24Stencil8::DEPTH_MAX);
+		EXPECT_EQ(Unorm24Stencil8::GetStencil(value), 7);
+		EXPECT_TRUE(Unorm24Stencil8::Passes(Unorm24Stencil8::Encode(1.0f, 255), Unorm24Stencil8::CLEAR));
+
+		// The stencil takes no part in the depth test
+		EXPECT_TRUE(Unorm24Stencil8::Passes(Unorm24Stencil8::Encode(0.5f, 9), Unorm24Stencil8::Encode(0.5f, 3)));
+		EXPECT_FALSE(Unorm24Stencil8::Passes(Unorm24Stencil8::Encode(0.6f, 0), Unorm24Stencil8::Encode(0.5f, 255)));
+
+		EXPECT_EQ(GetDepthSize(DepthFormat::Unorm16), 2);
+		EXPECT_EQ(GetDepthSize(DepthFormat::Unorm24Stencil8), 4);
+	}
 }